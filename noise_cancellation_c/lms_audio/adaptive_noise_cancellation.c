@@ -1,105 +1,85 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-
-#define FRAME_SIZE 1024
-#define MU 0.0001  // Learning rate
-
-// WAV header structure
-typedef struct {
-    char chunkID[4];
-    int chunkSize;
-    char format[4];
-    char subchunk1ID[4];
-    int subchunk1Size;
-    short audioFormat;
-    short numChannels;
-    int sampleRate;
-    int byteRate;
-    short blockAlign;
-    short bitsPerSample;
-    char subchunk2ID[4];
-    int subchunk2Size;
-} WAVHeader;
-
-// Adaptive LMS Filter
-void lms_filter(short *desired, short *reference, short *output, int numSamples) {
-    float w = 0.0;  // Filter weight
-    float error, y;
-    
-    for (int i = 0; i < numSamples; i++) {
-        y = w * reference[i];   // Filtered output
-        error = desired[i] - y; // Error signal
-        w += MU * error * reference[i]; // Weight update
-        output[i] = (short) error;
-    }
-}
-
-// Read WAV file
-short *read_wav(const char *filename, WAVHeader *header, int *numSamples) {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        printf("Error opening input file!\n");
-        return NULL;
-    }
-
-    fread(header, sizeof(WAVHeader), 1, file);
-    *numSamples = header->subchunk2Size / sizeof(short);
-    
-    short *data = (short *)malloc(*numSamples * sizeof(short));
-    fread(data, sizeof(short), *numSamples, file);
-    fclose(file);
-    return data;
-}
-
-// Write WAV file
-void write_wav(const char *filename, WAVHeader *header, short *data, int numSamples) {
-    FILE *file = fopen(filename, "wb");
-    if (!file) {
-        printf("Error opening output file!\n");
-        return;
-    }
-
-    fwrite(header, sizeof(WAVHeader), 1, file);
-    fwrite(data, sizeof(short), numSamples, file);
-    fclose(file);
-}
-
-int main(int argc, char *argv[]) {
-    if (argc != 4) {
-        printf("Usage: %s <desired.wav> <noise.wav> <output.wav>\n", argv[0]);
-        return 1;
-    }
-
-    WAVHeader header;
-    int numSamplesDesired, numSamplesNoise;
-
-    // Read desired signal (speech + noise)
-    short *desired = read_wav(argv[1], &header, &numSamplesDesired);
-    if (!desired) return 1;
-
-    // Read reference noise signal
-    short *reference = read_wav(argv[2], &header, &numSamplesNoise);
-    if (!reference || numSamplesDesired != numSamplesNoise) {
-        printf("Error: Mismatched file sizes!\n");
-        free(desired);
-        return 1;
-    }
-
-    // Allocate memory for output
-    short *output = (short *)malloc(numSamplesDesired * sizeof(short));
-    
-    // Apply LMS adaptive filter
-    lms_filter(desired, reference, output, numSamplesDesired);
-
-    // Write output WAV file
-    write_wav(argv[3], &header, output, numSamplesDesired);
-
-    // Clean up
-    free(desired);
-    free(reference);
-    free(output);
-
-    printf("Noise cancellation completed. Output saved to %s\n", argv[3]);
-    return 0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include "wav_io.h"
+#include "anc_engine.h"
+
+#define FRAME_SIZE 1024
+#define MU 0.0001  // Learning rate on the 16-bit sample scale
+
+int main(int argc, char *argv[]) {
+    int nlmsTaps = 0; // 0 selects the original single-weight LMS
+
+    int arg = 1;
+    if (argc > 1 && strcmp(argv[1], "--nlms") == 0) {
+        nlmsTaps = argc > 2 ? atoi(argv[2]) : 0;
+        arg = 3;
+    }
+
+    if (argc - arg != 3 || (arg == 3 && nlmsTaps <= 0)) {
+        printf("Usage: %s [--nlms <taps>] <desired.wav> <noise.wav> <output.wav>\n", argv[0]);
+        return 1;
+    }
+    const char *desiredPath = argv[arg];
+    const char *referencePath = argv[arg + 1];
+    const char *outputPath = argv[arg + 2];
+
+    WAVFile desiredWav, referenceWav;
+
+    // Read desired signal (speech + noise)
+    if (wav_open(desiredPath, &desiredWav) != 0) return 1;
+
+    // Read reference noise signal
+    if (wav_open(referencePath, &referenceWav) != 0) {
+        wav_close(&desiredWav);
+        return 1;
+    }
+
+    const short *desired = wav_samples_i16(&desiredWav);
+    const short *reference = wav_samples_i16(&referenceWav);
+    if (!desired || !reference || desiredWav.numSamples != referenceWav.numSamples) {
+        printf("Error: Inputs must be 16-bit PCM WAV files of the same size!\n");
+        wav_close(&desiredWav);
+        wav_close(&referenceWav);
+        return 1;
+    }
+    int numSamplesDesired = (int)desiredWav.numSamples;
+
+    // Allocate memory for output
+    short *output = (short *)malloc(numSamplesDesired * sizeof(short));
+    if (!output) {
+        printf("Error: Out of memory\n");
+        wav_close(&desiredWav);
+        wav_close(&referenceWav);
+        return 1;
+    }
+
+    // Apply LMS adaptive filter: a single weight by default, or normalized
+    // LMS over `taps` taps, where the step is divided by the energy of the
+    // reference window so one step size works for quiet and loud inputs alike.
+    // Engines see samples in [-1, 1), which scales the plain LMS step by 32768^2.
+    ANCEngine *lms = nlmsTaps > 0 ? anc_engine_create("nlms", nlmsTaps, 0.0f, FRAME_SIZE)
+                                  : anc_engine_create("lms", 1, (float)(MU * 32768.0 * 32768.0), FRAME_SIZE);
+    if (!lms) {
+        printf("Error: Out of memory\n");
+        wav_close(&desiredWav);
+        wav_close(&referenceWav);
+        free(output);
+        return 1;
+    }
+    anc_engine_process_i16(lms, reference, desired, output, numSamplesDesired);
+    anc_engine_destroy(lms);
+
+    // Write output WAV file
+    int status = wav_write_i16(outputPath, &desiredWav.fmt, output, desiredWav.numSamples);
+
+    // Clean up
+    wav_close(&desiredWav);
+    wav_close(&referenceWav);
+    free(output);
+    if (status != 0) return 1;
+
+    printf("Noise cancellation completed. Output saved to %s\n", outputPath);
+    return 0;
+}
@@ -1,58 +1,203 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <sndfile.h>
-
-#define BUFFER_SIZE 1024  // Number of samples processed per iteration
-
-int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        printf("Usage: %s <input_audio.wav>\n", argv[0]);
-        return 1;
-    }
-
-    SNDFILE *infile;
-    SF_INFO sfinfo;
-    
-    // Open the audio file
-    infile = sf_open(argv[1], SFM_READ, &sfinfo);
-    if (!infile) {
-        printf("Error: Unable to open file %s\n", argv[1]);
-        return 1;
-    }
-
-    printf("Audio file details:\n");
-    printf("Sample Rate: %d Hz\n", sfinfo.samplerate);
-    printf("Channels: %d\n", sfinfo.channels);
-    printf("Frames: %lld\n", sfinfo.frames);
-
-    // Open the output file
-    FILE *outfile = fopen("numaudio.txt", "w");
-    if (!outfile) {
-        perror("Error opening numaudio.txt");
-        sf_close(infile);
-        return 1;
-    }
-
-    // Write metadata to the file
-    fprintf(outfile, "Sample Rate: %d Hz\n", sfinfo.samplerate);
-    fprintf(outfile, "Channels: %d\n", sfinfo.channels);
-    fprintf(outfile, "Frames: %lld\n\n", sfinfo.frames);
-
-    // Buffer to store samples
-    float buffer[BUFFER_SIZE];
-
-    // Read samples and write to file
-    sf_count_t readcount;
-    while ((readcount = sf_readf_float(infile, buffer, BUFFER_SIZE)) > 0) {
-        for (sf_count_t i = 0; i < readcount * sfinfo.channels; i++) {
-            fprintf(outfile, "%f\n", buffer[i]);  // Write each sample
-        }
-    }
-
-    printf("Conversion complete. Data saved to numaudio.txt\n");
-
-    // Cleanup
-    fclose(outfile);
-    sf_close(infile);
-    return 0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sndfile.h>
+#include "wav_io.h"    // Host byte order check: raw and .npy output is written as in memory
+
+#define BUFFER_FRAMES 65536         // Frames read per iteration
+#define OUTPUT_BUFFER (1 << 22)     // Bytes collected before each write
+#define TEXT_SAMPLE_MAX 64          // Longest formatted sample, newline included
+#define NPY_HEADER_SIZE 128         // Fixed, so the shape can be patched in place
+
+typedef enum {
+    FORMAT_TEXT,   // One "%f" sample per line after a short metadata block
+    FORMAT_F32,    // Raw interleaved little-endian float32
+    FORMAT_NPY     // NumPy .npy array of shape (frames, channels), float32
+} DumpFormat;
+
+static const char *formatNames[] = {"text", "f32", "npy"};
+static const char *defaultOutputs[] = {"numaudio.txt", "numaudio.f32", "numaudio.npy"};
+
+// Same text as fprintf("%f\n"), without going through printf. A float has at
+// most 24 significant bits and 1e6 = 2^6 * 15625 adds 14, so value * 1e6 is
+// exact in a double and rounding it to an integer with ties to even is
+// exactly the rounding printf applies to the sixth decimal.
+static int format_sample(float value, char *out) {
+    double scaled = (double)value * 1e6;
+    if (!(fabs(scaled) < 9.0e18)) return sprintf(out, "%f\n", value); // NaN, inf and huge values
+
+    char *p = out;
+    if (signbit(value)) *p++ = '-';
+
+    unsigned long long units = (unsigned long long)nearbyint(fabs(scaled));
+    unsigned long long whole = units / 1000000;
+    unsigned int fraction = (unsigned int)(units % 1000000);
+
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole);
+    while (n) *p++ = digits[--n];
+
+    *p++ = '.';
+    for (int i = 5; i >= 0; i--) {
+        p[i] = (char)('0' + fraction % 10);
+        fraction /= 10;
+    }
+    p += 6;
+    *p++ = '\n';
+    return (int)(p - out);
+}
+
+// Version 1.0 .npy header, padded with spaces to NPY_HEADER_SIZE bytes
+static int write_npy_header(FILE *file, long long frames, int channels) {
+    char header[NPY_HEADER_SIZE];
+    memset(header, ' ', sizeof(header));
+    memcpy(header, "\x93NUMPY\x01\x00", 8);
+    header[8] = (char)((NPY_HEADER_SIZE - 10) & 0xff);
+    header[9] = (char)((NPY_HEADER_SIZE - 10) >> 8);
+
+    char dict[NPY_HEADER_SIZE];
+    int length = snprintf(dict, sizeof(dict), "{'descr': '<f4', 'fortran_order': False, 'shape': (%lld, %d), }",
+                          frames, channels);
+    if (length < 0 || length > NPY_HEADER_SIZE - 11) return -1;
+    memcpy(header + 10, dict, length);
+    header[NPY_HEADER_SIZE - 1] = '\n';
+
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header) ? 0 : -1;
+}
+
+// Sample rate and layout for the binary formats, next to the data as <output>.json
+static int write_metadata(const char *outputPath, DumpFormat format, const SF_INFO *info, long long frames) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s.json", outputPath);
+
+    FILE *file = fopen(path, "w");
+    if (!file) return -1;
+    fprintf(file, "{\"format\": \"%s\", \"dtype\": \"float32\", \"byte_order\": \"little\", "
+                  "\"layout\": \"interleaved\", \"sample_rate\": %d, \"channels\": %d, \"frames\": %lld}\n",
+            formatNames[format], info->samplerate, info->channels, frames);
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    DumpFormat format = FORMAT_TEXT;
+    const char *outputPath = NULL;
+
+    int arg = 1;
+    for (; arg + 1 < argc && strncmp(argv[arg], "--", 2) == 0; arg += 2) {
+        if (strcmp(argv[arg], "--format") == 0) {
+            int found = 0;
+            for (int i = 0; i < 3; i++) {
+                if (strcmp(argv[arg + 1], formatNames[i]) == 0) {
+                    format = (DumpFormat)i;
+                    found = 1;
+                }
+            }
+            if (!found) break;
+        } else if (strcmp(argv[arg], "--output") == 0) {
+            outputPath = argv[arg + 1];
+        } else {
+            break;
+        }
+    }
+
+    if (argc - arg != 1) {
+        printf("Usage: %s [--format text|f32|npy] [--output FILE] <input_audio.wav>\n", argv[0]);
+        return 1;
+    }
+    const char *inputPath = argv[arg];
+    if (!outputPath) outputPath = defaultOutputs[format];
+
+    SNDFILE *infile;
+    SF_INFO sfinfo;
+    memset(&sfinfo, 0, sizeof(sfinfo));
+
+    // Open the audio file
+    infile = sf_open(inputPath, SFM_READ, &sfinfo);
+    if (!infile) {
+        printf("Error: Unable to open file %s\n", inputPath);
+        return 1;
+    }
+
+    printf("Audio file details:\n");
+    printf("Sample Rate: %d Hz\n", sfinfo.samplerate);
+    printf("Channels: %d\n", sfinfo.channels);
+    printf("Frames: %lld\n", (long long)sfinfo.frames);
+
+    // Open the output file; the data goes out in OUTPUT_BUFFER-sized writes
+    FILE *outfile = fopen(outputPath, format == FORMAT_TEXT ? "w" : "wb");
+    if (!outfile) {
+        perror("Error opening output file");
+        sf_close(infile);
+        return 1;
+    }
+    setvbuf(outfile, NULL, _IOFBF, OUTPUT_BUFFER);
+
+    // Buffers for one block of interleaved samples and its text
+    float *buffer = (float *)malloc((size_t)BUFFER_FRAMES * sfinfo.channels * sizeof(float));
+    char *text = format == FORMAT_TEXT ? (char *)malloc(OUTPUT_BUFFER) : NULL;
+    if (!buffer || (format == FORMAT_TEXT && !text)) {
+        printf("Error: Out of memory\n");
+        free(buffer);
+        free(text);
+        fclose(outfile);
+        sf_close(infile);
+        return 1;
+    }
+
+    // Write metadata to the file
+    int status = 0;
+    if (format == FORMAT_TEXT) {
+        fprintf(outfile, "Sample Rate: %d Hz\n", sfinfo.samplerate);
+        fprintf(outfile, "Channels: %d\n", sfinfo.channels);
+        fprintf(outfile, "Frames: %lld\n\n", (long long)sfinfo.frames);
+    } else if (format == FORMAT_NPY) {
+        status = write_npy_header(outfile, (long long)sfinfo.frames, sfinfo.channels);
+    }
+
+    // Read samples and write to file, float32 blocks as read
+    long long frames = 0;
+    size_t fill = 0;
+    sf_count_t readcount;
+    while (status == 0 && (readcount = sf_readf_float(infile, buffer, BUFFER_FRAMES)) > 0) {
+        size_t count = (size_t)readcount * sfinfo.channels;
+        frames += readcount;
+
+        if (format != FORMAT_TEXT) {
+            if (fwrite(buffer, sizeof(float), count, outfile) != count) status = -1;
+            continue;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (fill > OUTPUT_BUFFER - TEXT_SAMPLE_MAX) {
+                if (fwrite(text, 1, fill, outfile) != fill) status = -1;
+                fill = 0;
+            }
+            fill += format_sample(buffer[i], text + fill);
+        }
+    }
+    if (status == 0 && fill > 0 && fwrite(text, 1, fill, outfile) != fill) status = -1;
+
+    // The header promised sfinfo.frames; fix the shape if the file held fewer
+    if (status == 0 && format == FORMAT_NPY && frames != (long long)sfinfo.frames) {
+        if (fseek(outfile, 0, SEEK_SET) != 0 || write_npy_header(outfile, frames, sfinfo.channels) != 0) status = -1;
+    }
+    if (fclose(outfile) != 0) status = -1;
+    if (status == 0 && format != FORMAT_TEXT && write_metadata(outputPath, format, &sfinfo, frames) != 0) status = -1;
+
+    // Cleanup
+    free(buffer);
+    free(text);
+    sf_close(infile);
+
+    if (status != 0) {
+        printf("Error writing %s\n", outputPath);
+        return 1;
+    }
+    printf("Conversion complete. Data saved to %s\n", outputPath);
+    return 0;
+}
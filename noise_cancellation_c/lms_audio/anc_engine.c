@@ -0,0 +1,606 @@
+#include "anc_engine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "lms_stream.h"
+#include "lms_q15.h"
+#include "fdaf.h"
+#include "subband.h"
+#include "stft.h"
+#include "rls_filter.h"
+#include "rls_lattice.h"
+#include "delay_line.h"
+#include "simd_kernels.h"
+#include "dsp_math.h"
+
+#define NLMS_EPS 1e-6f      // Keeps the NLMS step bounded during silence
+#define NAMES_SIZE 256
+#define SUBBAND_BANDS 64    // DFT size of the subband filterbank
+#define SUBBAND_LOW_LATENCY_BANDS 32
+#define SUBBAND_OVERLAP 3   // Prototype length in DFT lengths
+#define LPC_FRAME 1024      // Samples per AR estimate
+#define LPC_MAX_ORDER 64
+#define LPC_WHITE_NOISE 1e-5 // Added to r[0] relative to itself so Levinson-Durbin stays well conditioned
+
+static short saturate16(double v) {
+    if (v > 32767.0) return 32767;
+    if (v < -32768.0) return -32768;
+    return (short)v;
+}
+
+void anc_pcm_to_float(const short *in, float *out, int count) {
+    simd_mix_i16_f32(in, 1, out, 1.0f / 32768.0f, count);
+}
+
+void anc_float_to_pcm(const float *in, short *out, int count) {
+    simd_f32_to_i16(in, out, 32768.0f, count);
+}
+
+// ---- LMS and NLMS ----
+
+static int lms_engine_init(ANCEngine *e) {
+    LMSStream *s = (LMSStream *)malloc(sizeof(LMSStream));
+    if (!s || lms_stream_init(s, e->taps, e->mu, e->maxBlock) != 0) {
+        free(s);
+        return -1;
+    }
+    e->state = s;
+    return 0;
+}
+
+static int nlms_engine_init(ANCEngine *e) {
+    if (lms_engine_init(e) != 0) return -1;
+    lms_stream_enable_nlms((LMSStream *)e->state, NLMS_EPS);
+    return 0;
+}
+
+static void lms_engine_release(ANCEngine *e) {
+    lms_stream_free((LMSStream *)e->state);
+    free(e->state);
+}
+
+static void lms_engine_reset(ANCEngine *e) {
+    lms_stream_reset((LMSStream *)e->state);
+}
+
+static void lms_engine_process(ANCEngine *e, const float *x, const float *d, float *out, int count) {
+    lms_stream_process((LMSStream *)e->state, x, d, out, count);
+}
+
+// ---- Fixed-point LMS ----
+
+static int q15_engine_init(ANCEngine *e) {
+    LMSQ15 *s = (LMSQ15 *)malloc(sizeof(LMSQ15));
+    if (!s || e->mu >= 1.0f || lms_q15_init(s, e->taps, e->mu, e->maxBlock) != 0) {
+        free(s);
+        return -1;
+    }
+    e->state = s;
+    return 0;
+}
+
+static void q15_engine_release(ANCEngine *e) {
+    lms_q15_free((LMSQ15 *)e->state);
+    free(e->state);
+}
+
+static void q15_engine_reset(ANCEngine *e) {
+    lms_q15_reset((LMSQ15 *)e->state);
+}
+
+static void q15_engine_process(ANCEngine *e, const short *x, const short *d, short *out, int count) {
+    lms_q15_process((LMSQ15 *)e->state, x, d, out, count);
+}
+
+// ---- Frequency-domain block LMS ----
+
+static int fdaf_engine_setup(ANCEngine *e, int constrained) {
+    FDAFilter *f = (FDAFilter *)malloc(sizeof(FDAFilter));
+    if (!f || fdaf_init(f, e->taps, e->mu, constrained) != 0) {
+        free(f);
+        return -1;
+    }
+    e->state = f;
+    e->latency = e->taps;
+    return 0;
+}
+
+static int fdaf_engine_init(ANCEngine *e) {
+    return fdaf_engine_setup(e, 1);
+}
+
+static int fdafu_engine_init(ANCEngine *e) {
+    return fdaf_engine_setup(e, 0);
+}
+
+static void fdaf_engine_release(ANCEngine *e) {
+    fdaf_free((FDAFilter *)e->state);
+    free(e->state);
+}
+
+static void fdaf_engine_reset(ANCEngine *e) {
+    fdaf_reset((FDAFilter *)e->state);
+}
+
+static void fdaf_engine_process(ANCEngine *e, const float *x, const float *d, float *out, int count) {
+    fdaf_process((FDAFilter *)e->state, x, d, out, count);
+}
+
+// Plans are cached without locking
+static int fdaf_engine_prepare(int taps) {
+    return fft_plan_get(2 * taps) ? 0 : -1;
+}
+
+// ---- Subband NLMS ----
+
+static int subband_engine_setup(ANCEngine *e, int bands) {
+    SubbandFilter *f = (SubbandFilter *)malloc(sizeof(SubbandFilter));
+    if (!f || subband_init(f, bands, SUBBAND_OVERLAP, e->taps, e->mu) != 0) {
+        free(f);
+        return -1;
+    }
+    e->state = f;
+    e->latency = subband_latency(f);
+    return 0;
+}
+
+static int subband_engine_init(ANCEngine *e) {
+    return subband_engine_setup(e, SUBBAND_BANDS);
+}
+
+static int subband_ll_engine_init(ANCEngine *e) {
+    return subband_engine_setup(e, SUBBAND_LOW_LATENCY_BANDS);
+}
+
+static void subband_engine_release(ANCEngine *e) {
+    subband_free((SubbandFilter *)e->state);
+    free(e->state);
+}
+
+static void subband_engine_reset(ANCEngine *e) {
+    subband_reset((SubbandFilter *)e->state);
+}
+
+static void subband_engine_process(ANCEngine *e, const float *x, const float *d, float *out, int count) {
+    subband_process((SubbandFilter *)e->state, x, d, out, count);
+}
+
+static int subband_engine_prepare(int taps) {
+    (void)taps;
+    return fft_plan_get(SUBBAND_BANDS) && fft_plan_get(SUBBAND_LOW_LATENCY_BANDS) ? 0 : -1;
+}
+
+// ---- STFT noise suppression ----
+
+static int stft_engine_init(ANCEngine *e) {
+    STFTDenoiser *s = (STFTDenoiser *)malloc(sizeof(STFTDenoiser));
+    if (!s || stft_init(s, e->taps) != 0) {
+        free(s);
+        return -1;
+    }
+    e->state = s;
+    e->latency = stft_latency(s);
+    return 0;
+}
+
+static void stft_engine_release(ANCEngine *e) {
+    stft_free((STFTDenoiser *)e->state);
+    free(e->state);
+}
+
+static void stft_engine_reset(ANCEngine *e) {
+    stft_reset((STFTDenoiser *)e->state);
+}
+
+static void stft_engine_process(ANCEngine *e, const float *x, const float *d, float *out, int count) {
+    (void)x;
+    stft_process((STFTDenoiser *)e->state, d, out, count);
+}
+
+static int stft_engine_prepare(int taps) {
+    return fft_plan_get(taps) ? 0 : -1;
+}
+
+// ---- RLS and lattice RLS ----
+//
+// Both run on the 16-bit sample scale their delta was chosen for; the float
+// entry point scales around them.
+
+static int rls_engine_init(ANCEngine *e) {
+    RLSFilter *f = (RLSFilter *)malloc(sizeof(RLSFilter));
+    if (!f || rls_init(f, e->taps, e->lambda, e->delta) != 0) {
+        free(f);
+        return -1;
+    }
+    e->state = f;
+    return 0;
+}
+
+static void rls_engine_release(ANCEngine *e) {
+    rls_free((RLSFilter *)e->state);
+    free(e->state);
+}
+
+static void rls_engine_reset(ANCEngine *e) {
+    rls_reset((RLSFilter *)e->state);
+}
+
+static void rls_engine_process(ANCEngine *e, const float *x, const float *d, float *out, int count) {
+    RLSFilter *f = (RLSFilter *)e->state;
+    for (int i = 0; i < count; i++) {
+        out[i] = (float)(rls_step(f, x[i] * 32768.0, d[i] * 32768.0) * (1.0 / 32768.0));
+    }
+}
+
+static void rls_engine_process_i16(ANCEngine *e, const short *x, const short *d, short *out, int count) {
+    RLSFilter *f = (RLSFilter *)e->state;
+    for (int i = 0; i < count; i++) {
+        out[i] = saturate16(round(rls_step(f, x[i], d[i])));
+    }
+}
+
+static int lattice_engine_init(ANCEngine *e) {
+    RLSLattice *f = (RLSLattice *)malloc(sizeof(RLSLattice));
+    if (!f || rls_lattice_init(f, e->taps, e->lambda, e->delta) != 0) {
+        free(f);
+        return -1;
+    }
+    e->state = f;
+    return 0;
+}
+
+static void lattice_engine_release(ANCEngine *e) {
+    rls_lattice_free((RLSLattice *)e->state);
+    free(e->state);
+}
+
+static void lattice_engine_reset(ANCEngine *e) {
+    rls_lattice_reset((RLSLattice *)e->state);
+}
+
+static void lattice_engine_process(ANCEngine *e, const float *x, const float *d, float *out, int count) {
+    RLSLattice *f = (RLSLattice *)e->state;
+    for (int i = 0; i < count; i++) {
+        out[i] = (float)(rls_lattice_step(f, x[i] * 32768.0, d[i] * 32768.0) * (1.0 / 32768.0));
+    }
+    e->resets = f->resets;
+}
+
+static void lattice_engine_process_i16(ANCEngine *e, const short *x, const short *d, short *out, int count) {
+    RLSLattice *f = (RLSLattice *)e->state;
+    for (int i = 0; i < count; i++) {
+        out[i] = saturate16(round(rls_lattice_step(f, x[i], d[i])));
+    }
+    e->resets = f->resets;
+}
+
+// ---- AR prediction ----
+//
+// Predicts the noise in d from its own past samples with fixed example AR
+// coefficients (zero beyond the third tap) and subtracts the prediction.
+// There is no reference input.
+
+static const double arCoefficients[] = {0.5, -0.3, 0.2}; // Newest sample first
+
+typedef struct {
+    DelayLine history;
+    double *weights;   // Oldest tap first, to match the delay line window
+} ARPredictor;
+
+static int predict_engine_init(ANCEngine *e) {
+    ARPredictor *p = (ARPredictor *)calloc(1, sizeof(ARPredictor));
+    if (!p) return -1;
+
+    p->weights = (double *)calloc(e->taps, sizeof(double));
+    if (!p->weights || delay_line_init(&p->history, e->taps) != 0) {
+        free(p->weights);
+        free(p);
+        return -1;
+    }
+    for (int i = 0; i < e->taps && i < 3; i++) p->weights[e->taps - 1 - i] = arCoefficients[i];
+
+    e->state = p;
+    return 0;
+}
+
+static void predict_engine_release(ANCEngine *e) {
+    ARPredictor *p = (ARPredictor *)e->state;
+    delay_line_free(&p->history);
+    free(p->weights);
+    free(p);
+}
+
+static void predict_engine_reset(ANCEngine *e) {
+    delay_line_reset(&((ARPredictor *)e->state)->history);
+}
+
+static void predict_engine_process_i16(ANCEngine *e, const short *x, const short *d, short *out, int count) {
+    ARPredictor *p = (ARPredictor *)e->state;
+    (void)x;
+
+    for (int i = 0; i < count; i++) {
+        // Predict noise from previous samples, then remove it from the current one
+        short predicted = (short)simd_dot_f64(p->weights, delay_line_window(&p->history), p->history.length);
+        out[i] = saturate16((double)d[i] - predicted);
+        delay_line_push(&p->history, d[i]);
+    }
+}
+
+// ---- Block-adaptive AR prediction ----
+//
+// Re-estimates the AR model every LPC_FRAME samples from the frame just
+// completed: Hann window, autocorrelation (one simd_dot_f32 per lag) and
+// Levinson-Durbin, O(order^2) per frame. The autocorrelation method always
+// gives a stable predictor. The model only uses past frames, so there is
+// no latency, and the prediction is applied to each block as one FIR pass,
+// an simd_axpy_f32 per tap over the whole block.
+
+typedef struct {
+    int order;
+    float *coeffs;     // a[k] predicts from the sample k + 1 back
+    float *buffer;     // order samples of history, then the current frame
+    float *window;     // Hann, LPC_FRAME
+    float *windowed;
+    int fill;          // Samples of the current frame in buffer
+} LPCPredictor;
+
+static void lpc_release(LPCPredictor *p) {
+    free(p->coeffs);
+    free(p->buffer);
+    free(p->window);
+    free(p->windowed);
+    free(p);
+}
+
+static int lpc_engine_init(ANCEngine *e) {
+    LPCPredictor *p = (LPCPredictor *)calloc(1, sizeof(LPCPredictor));
+    if (!p) return -1;
+
+    p->order = e->taps;
+    p->coeffs = (float *)calloc(p->order, sizeof(float));
+    p->buffer = (float *)calloc(p->order + LPC_FRAME, sizeof(float));
+    p->window = (float *)malloc(LPC_FRAME * sizeof(float));
+    p->windowed = (float *)malloc(LPC_FRAME * sizeof(float));
+    if (!p->coeffs || !p->buffer || !p->window || !p->windowed) {
+        lpc_release(p);
+        return -1;
+    }
+    for (int i = 0; i < LPC_FRAME; i++) {
+        p->window[i] = (float)(0.5 - 0.5 * cos(2.0 * DSP_PI * (i + 0.5) / LPC_FRAME));
+    }
+
+    e->state = p;
+    return 0;
+}
+
+static void lpc_engine_release(ANCEngine *e) {
+    lpc_release((LPCPredictor *)e->state);
+}
+
+static void lpc_engine_reset(ANCEngine *e) {
+    LPCPredictor *p = (LPCPredictor *)e->state;
+    memset(p->coeffs, 0, p->order * sizeof(float));
+    memset(p->buffer, 0, (p->order + LPC_FRAME) * sizeof(float));
+    p->fill = 0;
+}
+
+// New coefficients from the completed frame. Silence keeps the old ones.
+static void lpc_estimate(LPCPredictor *p) {
+    int order = p->order;
+    const float *frame = p->buffer + order;
+    for (int i = 0; i < LPC_FRAME; i++) p->windowed[i] = frame[i] * p->window[i];
+
+    double r[LPC_MAX_ORDER + 1], a[LPC_MAX_ORDER + 1], prev[LPC_MAX_ORDER + 1];
+    for (int k = 0; k <= order; k++) {
+        r[k] = simd_dot_f32(p->windowed + k, p->windowed, LPC_FRAME - k);
+    }
+    if (!(r[0] > 0.0)) return;
+    r[0] *= 1.0 + LPC_WHITE_NOISE;
+
+    // Levinson-Durbin: a[1..i] is the order-i predictor, err its residual energy
+    double err = r[0];
+    for (int i = 1; i <= order; i++) {
+        double acc = r[i];
+        for (int j = 1; j < i; j++) acc -= a[j] * r[i - j];
+        double k = acc / err;
+
+        memcpy(prev, a, i * sizeof(double));
+        a[i] = k;
+        for (int j = 1; j < i; j++) a[j] = prev[j] - k * prev[i - j];
+        err *= 1.0 - k * k;
+        if (err <= 0.0) {
+            // Numerically singular: keep the orders solved so far
+            for (int j = i + 1; j <= order; j++) a[j] = 0.0;
+            break;
+        }
+    }
+    for (int k = 0; k < order; k++) p->coeffs[k] = (float)a[k + 1];
+}
+
+static void lpc_engine_process(ANCEngine *e, const float *x, const float *d, float *out, int count) {
+    LPCPredictor *p = (LPCPredictor *)e->state;
+    int order = p->order;
+    (void)x;
+
+    while (count > 0) {
+        int n = LPC_FRAME - p->fill < count ? LPC_FRAME - p->fill : count;
+        float *current = p->buffer + order + p->fill;
+        memcpy(current, d, n * sizeof(float));
+
+        // out = d - sum a[k] * d[n - k - 1], one tap at a time across the block
+        memcpy(out, d, n * sizeof(float));
+        for (int k = 0; k < order; k++) simd_axpy_f32(out, current - k - 1, -p->coeffs[k], n);
+
+        p->fill += n;
+        if (p->fill == LPC_FRAME) {
+            lpc_estimate(p);
+            memmove(p->buffer, p->buffer + LPC_FRAME, order * sizeof(float));
+            p->fill = 0;
+        }
+        d += n;
+        out += n;
+        count -= n;
+    }
+}
+
+// ---- Registry ----
+
+static const ANCEngineType engineTypes[] = {
+    {"lms", "Time-domain LMS, sample by sample", 128, 0, 0.01f, 0,
+     lms_engine_init, lms_engine_release, lms_engine_reset, lms_engine_process, NULL, NULL},
+    {"nlms", "LMS with the step normalized by the reference energy", 128, 0, 0.05f, 0,
+     nlms_engine_init, lms_engine_release, lms_engine_reset, lms_engine_process, NULL, NULL},
+    {"fdaf", "Constrained frequency-domain block LMS", 128, 0, 0.01f, ANC_POWER_OF_TWO,
+     fdaf_engine_init, fdaf_engine_release, fdaf_engine_reset, fdaf_engine_process, NULL, fdaf_engine_prepare},
+    {"fdaf-unconstrained", "Frequency-domain block LMS without the gradient constraint", 128, 0, 0.01f, ANC_POWER_OF_TWO,
+     fdafu_engine_init, fdaf_engine_release, fdaf_engine_reset, fdaf_engine_process, NULL, fdaf_engine_prepare},
+    {"subband", "NLMS per band of a 64-point oversampled DFT filterbank", 128, 0, 0.05f, 0,
+     subband_engine_init, subband_engine_release, subband_engine_reset, subband_engine_process, NULL,
+     subband_engine_prepare},
+    {"subband-low-latency", "Subband NLMS on a 32-point filterbank: half the delay", 128, 0, 0.05f, 0,
+     subband_ll_engine_init, subband_engine_release, subband_engine_reset, subband_engine_process, NULL,
+     subband_engine_prepare},
+    {"q15", "Fixed-point LMS on the 16-bit samples, bit-exact", 128, 0, 0.01f, 0,
+     q15_engine_init, q15_engine_release, q15_engine_reset, NULL, q15_engine_process, NULL},
+    {"rls", "Recursive least squares", 32, 0, 0.0f, ANC_QUADRATIC | ANC_FORGETTING,
+     rls_engine_init, rls_engine_release, rls_engine_reset, rls_engine_process, rls_engine_process_i16, NULL},
+    {"lattice", "Least-squares lattice, RLS at O(order) per sample", 32, 0, 0.0f, ANC_FORGETTING,
+     lattice_engine_init, lattice_engine_release, lattice_engine_reset, lattice_engine_process,
+     lattice_engine_process_i16, NULL},
+    {"predict", "Fixed AR prediction of the noise from the input itself", 3, 0, 0.0f, ANC_NO_REFERENCE,
+     predict_engine_init, predict_engine_release, predict_engine_reset, NULL, predict_engine_process_i16, NULL},
+    {"lpc", "AR prediction re-estimated every frame by Levinson-Durbin", 16, LPC_MAX_ORDER, 0.0f, ANC_NO_REFERENCE,
+     lpc_engine_init, lpc_engine_release, lpc_engine_reset, lpc_engine_process, NULL, NULL},
+    {"stft", "STFT spectral subtraction with a Wiener gain; taps is the frame length", 512, 0, 0.0f,
+     ANC_POWER_OF_TWO | ANC_NO_REFERENCE, stft_engine_init, stft_engine_release, stft_engine_reset,
+     stft_engine_process, NULL, stft_engine_prepare},
+};
+
+#define ENGINE_TYPE_COUNT ((int)(sizeof(engineTypes) / sizeof(engineTypes[0])))
+
+int anc_engine_count(void) {
+    return ENGINE_TYPE_COUNT;
+}
+
+const ANCEngineType *anc_engine_type(int index) {
+    return index >= 0 && index < ENGINE_TYPE_COUNT ? &engineTypes[index] : NULL;
+}
+
+const ANCEngineType *anc_engine_find(const char *name) {
+    for (int i = 0; i < ENGINE_TYPE_COUNT; i++) {
+        if (strcmp(engineTypes[i].name, name) == 0) return &engineTypes[i];
+    }
+    return NULL;
+}
+
+const char *anc_engine_names(const char *separator) {
+    static char names[NAMES_SIZE];
+    size_t length = 0;
+
+    names[0] = '\0';
+    for (int i = 0; i < ENGINE_TYPE_COUNT; i++) {
+        int written = snprintf(names + length, sizeof(names) - length, "%s%s", i ? separator : "",
+                               engineTypes[i].name);
+        if (written < 0 || (size_t)written >= sizeof(names) - length) break;
+        length += written;
+    }
+    return names;
+}
+
+static int valid_taps(const ANCEngineType *type, int taps) {
+    if (taps <= 0 || (type->maxTaps > 0 && taps > type->maxTaps)) return 0;
+    return !(type->flags & ANC_POWER_OF_TWO) || (taps & (taps - 1)) == 0;
+}
+
+int anc_engine_prepare(const ANCEngineType *type, int taps) {
+    if (taps <= 0) taps = type->defaultTaps;
+    if (!valid_taps(type, taps)) return -1;
+    return type->prepare ? type->prepare(taps) : 0;
+}
+
+ANCEngine *anc_engine_create_tuned(const char *name, int taps, float mu, double lambda, double delta, int maxBlock) {
+    const ANCEngineType *type = anc_engine_find(name);
+    if (!type || maxBlock <= 0) return NULL;
+
+    ANCEngine *e = (ANCEngine *)calloc(1, sizeof(ANCEngine));
+    if (!e) return NULL;
+
+    e->type = type;
+    e->taps = taps > 0 ? taps : type->defaultTaps;
+    e->mu = mu > 0.0f ? mu : type->defaultMu;
+    e->lambda = lambda > 0.0 ? lambda : ANC_DEFAULT_LAMBDA;
+    e->delta = delta > 0.0 ? delta : ANC_DEFAULT_DELTA;
+    e->maxBlock = maxBlock;
+
+    // The non-native entry point converts one block at a time
+    if (!type->processI16) e->scratch = (float *)malloc(3 * (size_t)maxBlock * sizeof(float));
+    if (!type->process) e->scratch16 = (short *)malloc(3 * (size_t)maxBlock * sizeof(short));
+
+    if (!valid_taps(type, e->taps) || (!type->processI16 && !e->scratch) || (!type->process && !e->scratch16) ||
+        type->init(e) != 0) {
+        free(e->scratch);
+        free(e->scratch16);
+        free(e);
+        return NULL;
+    }
+    return e;
+}
+
+ANCEngine *anc_engine_create(const char *name, int taps, float mu, int maxBlock) {
+    return anc_engine_create_tuned(name, taps, mu, 0.0, 0.0, maxBlock);
+}
+
+void anc_engine_destroy(ANCEngine *e) {
+    if (!e) return;
+    e->type->release(e);
+    free(e->scratch);
+    free(e->scratch16);
+    free(e);
+}
+
+void anc_engine_reset(ANCEngine *e) {
+    e->type->reset(e);
+    e->resets = 0;
+}
+
+void anc_engine_process(ANCEngine *e, const float *x, const float *d, float *out, int count) {
+    if (e->type->process) {
+        e->type->process(e, x, d, out, count);
+        return;
+    }
+
+    short *x16 = e->scratch16, *d16 = x16 + e->maxBlock, *e16 = d16 + e->maxBlock;
+    while (count > 0) {
+        int block = count < e->maxBlock ? count : e->maxBlock;
+        if (x) anc_float_to_pcm(x, x16, block);
+        anc_float_to_pcm(d, d16, block);
+        e->type->processI16(e, x ? x16 : NULL, d16, e16, block);
+        anc_pcm_to_float(e16, out, block);
+        if (x) x += block;
+        d += block;
+        out += block;
+        count -= block;
+    }
+}
+
+void anc_engine_process_i16(ANCEngine *e, const short *x, const short *d, short *out, int count) {
+    if (e->type->processI16) {
+        e->type->processI16(e, x, d, out, count);
+        return;
+    }
+
+    float *xf = e->scratch, *df = xf + e->maxBlock, *ef = df + e->maxBlock;
+    while (count > 0) {
+        int block = count < e->maxBlock ? count : e->maxBlock;
+        if (x) anc_pcm_to_float(x, xf, block);
+        anc_pcm_to_float(d, df, block);
+        e->type->process(e, x ? xf : NULL, df, ef, block);
+        anc_float_to_pcm(ef, out, block);
+        if (x) x += block;
+        d += block;
+        out += block;
+        count -= block;
+    }
+}
@@ -0,0 +1,108 @@
+// Common block-processing interface for every noise cancellation algorithm.
+//
+// Each algorithm is registered once as an ANCEngineType and created by name.
+// An engine is stateful: process() takes one block of the noise reference x
+// and the noisy input d, writes the cleaned block to out and carries its
+// filter state over to the next call, so callers can push audio of any
+// length through in blocks of any size.
+//
+// Engines work natively on float samples in [-1, 1), on 16-bit PCM, or on
+// both. Both entry points are always available; the missing one converts
+// through per-engine scratch buffers, so file I/O, threading and buffering
+// code never needs to know which kind it is driving.
+#ifndef ANC_ENGINE_H
+#define ANC_ENGINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ANC_POWER_OF_TWO  1   // taps must be a power of two
+#define ANC_NO_REFERENCE  2   // Single-input: x is ignored and may be NULL
+#define ANC_QUADRATIC     4   // Cost per sample grows with taps^2
+#define ANC_FORGETTING    8   // Takes a forgetting factor and regularization (lambda, delta)
+
+typedef struct ANCEngine ANCEngine;
+
+typedef struct {
+    const char *name;
+    const char *description;
+    int defaultTaps;
+    int maxTaps;                  // 0 for no limit
+    float defaultMu;              // 0 for engines without a step size
+    int flags;
+
+    // Set up e->state for e->taps, e->mu and e->maxBlock and set e->latency.
+    // Returns 0 on success, -1 for bad parameters or allocation failure.
+    int (*init)(ANCEngine *e);
+    void (*release)(ANCEngine *e);
+    void (*reset)(ANCEngine *e);
+
+    // At least one of the two is set
+    void (*process)(ANCEngine *e, const float *x, const float *d, float *out, int count);
+    void (*processI16)(ANCEngine *e, const short *x, const short *d, short *out, int count);
+
+    // Optional: build tables shared between instances, before threads use them
+    int (*prepare)(int taps);
+} ANCEngineType;
+
+struct ANCEngine {
+    const ANCEngineType *type;
+    int taps;
+    float mu;
+    int maxBlock;     // Largest block passed to the native entry point
+    int latency;      // Samples of delay between an input and its output
+    double lambda;    // Forgetting factor, ANC_FORGETTING engines only
+    double delta;     // Initial regularization, ANC_FORGETTING engines only
+    long resets;      // Numerical re-initializations, for engines that do them
+    void *state;      // Owned by the engine type
+
+    // Conversion scratch for the non-native entry point, 3 * maxBlock samples
+    float *scratch;
+    short *scratch16;
+};
+
+// Registry
+int anc_engine_count(void);
+const ANCEngineType *anc_engine_type(int index);
+const ANCEngineType *anc_engine_find(const char *name);
+
+// Engine names joined by `separator` (e.g. "lms|nlms|..."), for usage text
+const char *anc_engine_names(const char *separator);
+
+// Build shared tables for `taps` ahead of multithreaded use. Returns 0 on
+// success, -1 if the engine cannot run with that many taps.
+int anc_engine_prepare(const ANCEngineType *type, int taps);
+
+// taps <= 0 and mu <= 0 select the engine defaults. Returns NULL for an
+// unknown name, bad parameters or allocation failure.
+ANCEngine *anc_engine_create(const char *name, int taps, float mu, int maxBlock);
+
+// Same with every tunable parameter. lambda and delta only affect
+// ANC_FORGETTING engines; <= 0 selects ANC_DEFAULT_LAMBDA and ANC_DEFAULT_DELTA.
+#define ANC_DEFAULT_LAMBDA 0.99
+#define ANC_DEFAULT_DELTA 0.01
+ANCEngine *anc_engine_create_tuned(const char *name, int taps, float mu, double lambda, double delta, int maxBlock);
+void anc_engine_destroy(ANCEngine *e);
+void anc_engine_reset(ANCEngine *e);
+
+// x is the noise reference, d the noisy input and out receives the cleaned
+// signal. count may exceed maxBlock.
+void anc_engine_process(ANCEngine *e, const float *x, const float *d, float *out, int count);
+void anc_engine_process_i16(ANCEngine *e, const short *x, const short *d, short *out, int count);
+
+// 16-bit PCM <-> float in [-1, 1). The float side rounds to nearest and
+// saturates, so an unconverged filter clips instead of wrapping.
+void anc_pcm_to_float(const short *in, float *out, int count);
+void anc_float_to_pcm(const float *in, short *out, int count);
+
+// Non-zero if 16-bit PCM is the engine's native format
+static inline int anc_engine_native_i16(const ANCEngine *e) {
+    return e->type->processI16 != 0 && e->type->process == 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANC_ENGINE_H
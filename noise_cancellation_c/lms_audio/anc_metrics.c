@@ -0,0 +1,181 @@
+#include "anc_metrics.h"
+#include "simd_kernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SILENCE 1e-6              // Mean square below which a clean segment is silent (-60 dBFS)
+#define SEGMENTAL_MIN -10.0       // dB
+#define SEGMENTAL_MAX 35.0
+#define TINY 1e-20                // Keeps the ratios finite for all-zero input
+
+static double db(double signal, double noise) {
+    return 10.0 * log10((signal + TINY) / (noise + TINY));
+}
+
+int anc_metrics_init(ANCMetrics *m, int sampleRate, int channels, double settleSeconds, int hasClean) {
+    memset(m, 0, sizeof(*m));
+    if (sampleRate <= 0 || channels <= 0 || settleSeconds < 0.0) return -1;
+    m->sampleRate = sampleRate;
+    m->channels = channels;
+    m->hasClean = hasClean;
+    m->segment = (sampleRate * ANC_METRICS_SEGMENT_MS / 1000) * channels;
+    if (m->segment < channels) m->segment = channels;
+    m->settle = (long long)(settleSeconds * sampleRate) * channels;
+    return 0;
+}
+
+void anc_metrics_free(ANCMetrics *m) {
+    free(m->history);
+    m->history = NULL;
+    m->segments = m->capacity = 0;
+}
+
+static int close_segment(ANCMetrics *m) {
+    const double *c = m->current;
+    if (m->hasClean && c[METRIC_CLEAN] > SILENCE * m->fill) {
+        double snr = db(c[METRIC_CLEAN], c[METRIC_RESIDUAL]);
+        m->segmentalSum += snr < SEGMENTAL_MIN ? SEGMENTAL_MIN : snr > SEGMENTAL_MAX ? SEGMENTAL_MAX : snr;
+        m->segmentalCount++;
+    }
+
+    if (m->segments == m->capacity) {
+        int capacity = m->capacity ? 2 * m->capacity : 1024;
+        float *history = (float *)realloc(m->history, 2 * (size_t)capacity * sizeof(float));
+        if (!history) return -1;
+        m->history = history;
+        m->capacity = capacity;
+    }
+    m->history[2 * m->segments] = (float)(m->hasClean ? c[METRIC_CLEAN] : c[METRIC_NOISY]);
+    m->history[2 * m->segments + 1] = (float)(m->hasClean ? c[METRIC_RESIDUAL] : c[METRIC_OUTPUT]);
+    m->segments++;
+
+    memset(m->current, 0, sizeof(m->current));
+    m->fill = 0;
+    return 0;
+}
+
+// Samples of the next chunk: chunks end at segment boundaries and at the
+// settle point
+static int chunk_size(const ANCMetrics *m, int count) {
+    int n = m->segment - m->fill < count ? m->segment - m->fill : count;
+    if (m->samples < m->settle && m->settle - m->samples < n) n = (int)(m->settle - m->samples);
+    return n;
+}
+
+static int add_chunk(ANCMetrics *m, const double *sums, int n) {
+    for (int i = 0; i < METRIC_SUMS; i++) {
+        m->current[i] += sums[i];
+        if (m->samples >= m->settle) m->total[i] += sums[i];
+    }
+    m->samples += n;
+    m->fill += n;
+    return m->fill == m->segment ? close_segment(m) : 0;
+}
+
+int anc_metrics_push(ANCMetrics *m, const float *noisy, const float *out, const float *clean, int count) {
+    while (count > 0) {
+        int n = chunk_size(m, count);
+        double sums[METRIC_SUMS] = {0.0, 0.0, 0.0, 0.0, 0.0};
+        sums[METRIC_NOISY] = simd_dot_f32(noisy, noisy, n);
+        sums[METRIC_OUTPUT] = simd_dot_f32(out, out, n);
+        if (m->hasClean) {
+            sums[METRIC_CLEAN] = simd_dot_f32(clean, clean, n);
+            sums[METRIC_RESIDUAL] = simd_sqdiff_f32(out, clean, n);
+            sums[METRIC_INPUT_RESIDUAL] = simd_sqdiff_f32(noisy, clean, n);
+            clean += n;
+        }
+        if (add_chunk(m, sums, n) != 0) return -1;
+        noisy += n;
+        out += n;
+        count -= n;
+    }
+    return 0;
+}
+
+int anc_metrics_push_i16(ANCMetrics *m, const short *noisy, const short *out, const short *clean, int count) {
+    const double scale = 1.0 / (32768.0 * 32768.0);
+    while (count > 0) {
+        int n = chunk_size(m, count);
+        long long dd = simd_dot_i16(noisy, noisy, n), ee = simd_dot_i16(out, out, n);
+        double sums[METRIC_SUMS] = {0.0, 0.0, 0.0, 0.0, 0.0};
+        sums[METRIC_NOISY] = dd * scale;
+        sums[METRIC_OUTPUT] = ee * scale;
+        if (m->hasClean) {
+            // The differences expand into dot products, exact in 64 bits
+            long long ss = simd_dot_i16(clean, clean, n);
+            sums[METRIC_CLEAN] = ss * scale;
+            sums[METRIC_RESIDUAL] = (ee + ss - 2 * simd_dot_i16(out, clean, n)) * scale;
+            sums[METRIC_INPUT_RESIDUAL] = (dd + ss - 2 * simd_dot_i16(noisy, clean, n)) * scale;
+            clean += n;
+        }
+        if (add_chunk(m, sums, n) != 0) return -1;
+        noisy += n;
+        out += n;
+        count -= n;
+    }
+    return 0;
+}
+
+// End of the first window that comes within ANC_METRICS_CONVERGED dB of the
+// level over the last quarter of the segments
+static double convergence_time(const ANCMetrics *m) {
+    int count = m->segments, window = ANC_METRICS_WINDOW;
+    if (count < 2 * window) return -1.0;
+
+    int tail = count / 4 > window ? count / 4 : window;
+    double reference = 0.0, residual = 0.0;
+    for (int i = count - tail; i < count; i++) {
+        reference += m->history[2 * i];
+        residual += m->history[2 * i + 1];
+    }
+    double threshold = db(reference, residual) - ANC_METRICS_CONVERGED;
+
+    reference = residual = 0.0;
+    for (int i = 0; i < count; i++) {
+        reference += m->history[2 * i];
+        residual += m->history[2 * i + 1];
+        if (i >= window) {
+            reference -= m->history[2 * (i - window)];
+            residual -= m->history[2 * (i - window) + 1];
+        }
+        if (i >= window - 1 && db(reference > 0.0 ? reference : 0.0, residual > 0.0 ? residual : 0.0) >= threshold) {
+            return (double)(i + 1) * m->segment / ((double)m->sampleRate * m->channels);
+        }
+    }
+    return -1.0;
+}
+
+void anc_metrics_result(const ANCMetrics *m, ANCMetricsResult *r) {
+    memset(r, 0, sizeof(*r));
+    r->seconds = (double)m->samples / ((double)m->sampleRate * m->channels);
+    r->erle = db(m->total[METRIC_NOISY], m->total[METRIC_OUTPUT]);
+    r->hasClean = m->hasClean;
+    if (m->hasClean) {
+        r->snr = db(m->total[METRIC_CLEAN], m->total[METRIC_RESIDUAL]);
+        r->inputSnr = db(m->total[METRIC_CLEAN], m->total[METRIC_INPUT_RESIDUAL]);
+        r->segmentalSnr = m->segmentalCount ? m->segmentalSum / m->segmentalCount : SEGMENTAL_MIN;
+    }
+    r->convergence = convergence_time(m);
+}
+
+int anc_metrics_write_json(const ANCMetricsResult *r, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) return -1;
+
+    fprintf(file, "{\"seconds\": %.3f, \"erle_db\": %.3f", r->seconds, r->erle);
+    if (r->hasClean) {
+        fprintf(file, ", \"snr_db\": %.3f, \"input_snr_db\": %.3f, \"snr_gain_db\": %.3f, \"segmental_snr_db\": %.3f",
+                r->snr, r->inputSnr, r->snr - r->inputSnr, r->segmentalSnr);
+    } else {
+        fprintf(file, ", \"snr_db\": null, \"input_snr_db\": null, \"snr_gain_db\": null, \"segmental_snr_db\": null");
+    }
+    if (r->convergence >= 0.0) {
+        fprintf(file, ", \"convergence_seconds\": %.3f}\n", r->convergence);
+    } else {
+        fprintf(file, ", \"convergence_seconds\": null}\n");
+    }
+    return fclose(file) == 0 ? 0 : -1;
+}
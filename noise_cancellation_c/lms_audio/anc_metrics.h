@@ -0,0 +1,93 @@
+// Streaming quality metrics for a noise cancellation run.
+//
+// The cleaned output is pushed a block at a time together with the noisy
+// input it came from and, when there is one, the clean signal, all aligned
+// sample for sample. Each block is reduced by the SIMD kernels to per
+// segment energies (noisy, output, clean, output - clean, noisy - clean),
+// a few vector passes over data that is still in cache. From these:
+//   ERLE           10 log10(noisy energy / output energy)
+//   SNR            10 log10(clean energy / (output - clean) energy), and the
+//                  same for the noisy input, with a clean signal only
+//   segmental SNR  mean of the segment SNRs clamped to [-10, 35] dB, over
+//                  the segments where the clean signal is not silent
+//   convergence    end of the first window of ANC_METRICS_WINDOW segments
+//                  whose ERLE (SNR with a clean signal) comes within
+//                  ANC_METRICS_CONVERGED dB of that of the last quarter of
+//                  the run
+// ERLE and the SNRs leave out the first `settle` samples; the segment
+// measures cover the whole run. Convergence keeps two floats per segment,
+// about 0.4 KB per second of audio.
+#ifndef ANC_METRICS_H
+#define ANC_METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ANC_METRICS_SEGMENT_MS 20
+#define ANC_METRICS_WINDOW 10       // Segments per convergence window, 200 ms
+#define ANC_METRICS_CONVERGED 3.0   // dB short of the final level that counts as converged
+
+typedef enum {
+    METRIC_NOISY,
+    METRIC_OUTPUT,
+    METRIC_CLEAN,
+    METRIC_RESIDUAL,          // output - clean
+    METRIC_INPUT_RESIDUAL,    // noisy - clean
+    METRIC_SUMS
+} ANCMetricSum;
+
+typedef struct {
+    int sampleRate;
+    int channels;
+    int hasClean;
+    int segment;              // Interleaved samples per segment
+    long long settle;         // Interleaved samples left out of ERLE and SNR
+    long long samples;        // Pushed so far
+
+    double total[METRIC_SUMS];    // Past the settle point
+    double current[METRIC_SUMS];  // Current segment
+    int fill;                     // Samples in the current segment
+
+    // Per finished segment: the energy ratio convergence is judged by, as
+    // a (reference, residual) pair
+    float *history;
+    int segments, capacity;
+
+    double segmentalSum;
+    int segmentalCount;
+} ANCMetrics;
+
+typedef struct {
+    double seconds;           // Audio measured
+    double erle;              // dB
+    int hasClean;
+    double snr;               // dB, with a clean signal only
+    double inputSnr;
+    double segmentalSnr;
+    double convergence;       // Seconds, -1 if the run is too short to tell
+} ANCMetricsResult;
+
+// settleSeconds of the start are left out of ERLE and SNR. Returns 0 on
+// success, -1 for bad parameters.
+int anc_metrics_init(ANCMetrics *m, int sampleRate, int channels, double settleSeconds, int hasClean);
+void anc_metrics_free(ANCMetrics *m);
+
+// count interleaved samples; clean is ignored (and may be NULL) without a
+// clean signal. Returns 0, or -1 if the convergence history could not grow.
+int anc_metrics_push(ANCMetrics *m, const float *noisy, const float *out, const float *clean, int count);
+
+// The same for 16-bit PCM, measured in integers as if scaled by 1/32768
+int anc_metrics_push_i16(ANCMetrics *m, const short *noisy, const short *out, const short *clean, int count);
+
+void anc_metrics_result(const ANCMetrics *m, ANCMetricsResult *r);
+
+// One JSON object; the SNR fields are null without a clean signal.
+// Returns 0 on success, -1 if the file could not be written.
+int anc_metrics_write_json(const ANCMetricsResult *r, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANC_METRICS_H
@@ -0,0 +1,291 @@
+// Throughput benchmark for the filter kernels.
+//
+// Every registered engine is timed in isolation over a sweep of filter
+// orders, block sizes and sample formats, on a fixed pseudo-random signal so runs can be
+// diffed between builds. Each measurement repeats whole blocks until at least
+// --time seconds have passed and reports samples/s, ns/sample, TSC cycles
+// per tap and the real-time factor for one 44.1 kHz and one 48 kHz stream.
+// The int16 format includes the PCM <-> float conversion around the float
+// engines; engines that run on int16 natively (q15, predict) pay for the
+// conversion in the f32 format instead.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "anc_engine.h"
+#include "fft.h"
+#include "simd_kernels.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HAVE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#define SIGNAL_LENGTH 65536   // Samples of test signal cycled through by every run
+#define MAX_LIST 32           // Entries per --orders/--blocks list
+#define QUADRATIC_MAX_ORDER 1024 // Larger orders are skipped for O(order^2) engines (RLS: P alone is order^2 / 2 doubles)
+#define MIN_TIME 0.1          // Seconds per measurement
+
+typedef enum {
+    FORMAT_I16,
+    FORMAT_F32
+} SampleFormat;
+
+static const char *formatNames[] = {"i16", "f32"};
+
+// ---- Harness ----
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Time-stamp counter ticks; these run at the nominal clock, not the
+// (turbo) core clock, so cycles/tap is comparable across runs on one machine
+static unsigned long long read_tsc(void) {
+#if HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+typedef struct {
+    int length;
+    float *x, *d;        // Reference and noisy input
+    short *x16, *d16;
+} Signal;
+
+// Uniform noise in [-0.1, 0.1) as the reference; the noisy input is that
+// noise through a short FIR plus a tone. Fixed seed: same input every run.
+static int signal_init(Signal *s, int length) {
+    unsigned int seed = 12345;
+
+    s->length = length;
+    s->x = (float *)malloc(length * sizeof(float));
+    s->d = (float *)malloc(length * sizeof(float));
+    s->x16 = (short *)malloc(length * sizeof(short));
+    s->d16 = (short *)malloc(length * sizeof(short));
+    if (!s->x || !s->d || !s->x16 || !s->d16) return -1;
+
+    for (int i = 0; i < length; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        s->x[i] = ((seed >> 8) * (1.0f / 16777216.0f) - 0.5f) * 0.2f;
+    }
+    for (int i = 0; i < length; i++) {
+        float noise = 0.6f * s->x[i] + (i >= 3 ? -0.3f * s->x[i - 3] : 0.0f);
+        s->d[i] = noise + 0.1f * (float)((i % 100) - 50) / 50.0f;
+    }
+    anc_float_to_pcm(s->x, s->x16, length);
+    anc_float_to_pcm(s->d, s->d16, length);
+    return 0;
+}
+
+static void signal_free(Signal *s) {
+    free(s->x);
+    free(s->d);
+    free(s->x16);
+    free(s->d16);
+}
+
+typedef struct {
+    long long samples;
+    double seconds;
+    double cycles;
+} Measurement;
+
+// Engines run with their default step size
+static int measure(const ANCEngineType *type, const Signal *sig, int order, int block, SampleFormat format,
+                   double minTime, Measurement *m) {
+    ANCEngine *engine = anc_engine_create(type->name, order, 0.0f, block);
+    float *e = (float *)malloc(block * sizeof(float));
+    short *e16 = (short *)malloc(block * sizeof(short));
+    if (!engine || !e || !e16) {
+        free(e);
+        free(e16);
+        anc_engine_destroy(engine);
+        return -1;
+    }
+
+    // One untimed block brings code, tables and filter state into cache
+    int pos = 0;
+    int span = sig->length - block;
+    anc_engine_process(engine, sig->x, sig->d, e, block);
+
+    long long samples = 0;
+    unsigned long long c0 = read_tsc();
+    double t0 = now_seconds(), elapsed;
+    do {
+        if (format == FORMAT_I16) {
+            anc_engine_process_i16(engine, sig->x16 + pos, sig->d16 + pos, e16, block);
+        } else {
+            anc_engine_process(engine, sig->x + pos, sig->d + pos, e, block);
+        }
+        samples += block;
+        pos += block;
+        if (pos > span) pos = 0;
+        elapsed = now_seconds() - t0;
+    } while (elapsed < minTime);
+
+    m->cycles = (double)(read_tsc() - c0);
+    m->samples = samples;
+    m->seconds = elapsed;
+
+    free(e);
+    free(e16);
+    anc_engine_destroy(engine);
+    return 0;
+}
+
+// Comma-separated integers; returns the number parsed, or -1 on a bad entry
+// or more than max of them
+static int parse_list(const char *text, int *values, int max) {
+    int count = 0;
+    while (*text && count < max) {
+        char *end;
+        long v = strtol(text, &end, 10);
+        if (end == text || v <= 0) return -1;
+        values[count++] = (int)v;
+        text = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+    if (*text) {
+        printf("Error: A list takes at most %d values\n", max);
+        return -1;
+    }
+    return count;
+}
+
+static int listed(const char *list, const char *name) {
+    size_t length = strlen(name);
+    for (const char *p = list; p && *p;) {
+        const char *comma = strchr(p, ',');
+        size_t itemLength = comma ? (size_t)(comma - p) : strlen(p);
+        if (itemLength == length && strncmp(p, name, length) == 0) return 1;
+        p = comma ? comma + 1 : NULL;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int orders[MAX_LIST] = {8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+    int orderCount = 10;
+    int blocks[MAX_LIST] = {64, 256, 1024, 4096};
+    int blockCount = 4;
+    const char *kernelList = NULL;   // NULL: every engine
+    const char *formatList = "i16,f32";
+    double minTime = MIN_TIME;
+    int json = 0;
+
+    int arg = 1;
+    while (arg < argc) {
+        const char *value = arg + 1 < argc ? argv[arg + 1] : NULL;
+        if (strcmp(argv[arg], "--json") == 0) {
+            json = 1;
+            arg++;
+            continue;
+        }
+        if (!value) break;
+
+        if (strcmp(argv[arg], "--kernels") == 0) {
+            kernelList = value;
+        } else if (strcmp(argv[arg], "--orders") == 0) {
+            orderCount = parse_list(value, orders, MAX_LIST);
+        } else if (strcmp(argv[arg], "--blocks") == 0) {
+            blockCount = parse_list(value, blocks, MAX_LIST);
+        } else if (strcmp(argv[arg], "--formats") == 0) {
+            formatList = value;
+        } else if (strcmp(argv[arg], "--time") == 0) {
+            minTime = atof(value);
+        } else if (strcmp(argv[arg], "--simd") == 0) {
+            if (simd_select(value) != 0) {
+                printf("Error: SIMD level %s is not available on this CPU\n", value);
+                return 1;
+            }
+        } else {
+            break;
+        }
+        arg += 2;
+    }
+
+    if (arg != argc || orderCount <= 0 || blockCount <= 0 || minTime <= 0.0) {
+        printf("Usage: %s [--kernels %s] [--orders 8,16,...]"
+               " [--blocks 64,256,...] [--formats i16,f32] [--time SECONDS] [--simd LEVEL] [--json]\n", argv[0],
+               anc_engine_names(","));
+        return 1;
+    }
+
+    int longestBlock = 0;
+    for (int i = 0; i < blockCount; i++) {
+        if (blocks[i] > longestBlock) longestBlock = blocks[i];
+    }
+
+    Signal sig;
+    if (signal_init(&sig, SIGNAL_LENGTH > 2 * longestBlock ? SIGNAL_LENGTH : 2 * longestBlock) != 0) {
+        printf("Error: Memory allocation failed for the test signal\n");
+        signal_free(&sig);
+        return 1;
+    }
+
+    if (json) {
+        printf("{\n  \"simd\": \"%s\",\n  \"tsc\": %s,\n  \"results\": [", simd_level(), HAVE_TSC ? "true" : "false");
+    } else {
+        printf("kernel,format,simd,order,block,samples,seconds,samples_per_sec,ns_per_sample,cycles_per_tap,rtf_44100,rtf_48000\n");
+    }
+
+    int first = 1;
+    for (int ki = 0; ki < anc_engine_count(); ki++) {
+        const ANCEngineType *k = anc_engine_type(ki);
+        if (kernelList && !listed(kernelList, k->name)) continue;
+
+        for (int fi = 0; fi < 2; fi++) {
+            if (!listed(formatList, formatNames[fi])) continue;
+
+            for (int oi = 0; oi < orderCount; oi++) {
+                int order = orders[oi];
+                if ((k->flags & ANC_QUADRATIC) && order > QUADRATIC_MAX_ORDER) continue;
+                if ((k->flags & ANC_POWER_OF_TWO) && (order & (order - 1)) != 0) continue;
+                if (k->maxTaps > 0 && order > k->maxTaps) continue;
+
+                for (int bi = 0; bi < blockCount; bi++) {
+                    Measurement m;
+                    if (measure(k, &sig, order, blocks[bi], (SampleFormat)fi, minTime, &m) != 0) {
+                        fprintf(stderr, "Skipping %s order %d block %d: setup failed\n", k->name, order, blocks[bi]);
+                        continue;
+                    }
+
+                    double rate = m.samples / m.seconds;
+                    double nsPerSample = m.seconds * 1e9 / m.samples;
+                    double cyclesPerTap = HAVE_TSC ? m.cycles / ((double)m.samples * order) : 0.0;
+
+                    if (json) {
+                        printf("%s\n    {\"kernel\": \"%s\", \"format\": \"%s\", \"order\": %d, \"block\": %d, "
+                               "\"samples\": %lld, \"seconds\": %.6f, \"samples_per_sec\": %.1f, "
+                               "\"ns_per_sample\": %.3f, \"cycles_per_tap\": %.4f, "
+                               "\"rtf_44100\": %.2f, \"rtf_48000\": %.2f}",
+                               first ? "" : ",", k->name, formatNames[fi], order, blocks[bi], m.samples, m.seconds,
+                               rate, nsPerSample, cyclesPerTap, rate / 44100.0, rate / 48000.0);
+                    } else {
+                        printf("%s,%s,%s,%d,%d,%lld,%.6f,%.1f,%.3f,%.4f,%.2f,%.2f\n", k->name, formatNames[fi],
+                               simd_level(), order, blocks[bi], m.samples, m.seconds, rate, nsPerSample,
+                               cyclesPerTap, rate / 44100.0, rate / 48000.0);
+                    }
+                    fflush(stdout);
+                    first = 0;
+                }
+            }
+        }
+    }
+
+    if (json) printf("\n  ]\n}\n");
+
+    fft_plan_cache_free();
+    signal_free(&sig);
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "channel_pipeline.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Pick one channel out of interleaved 16-bit PCM as floats in [-1, 1)
+static void deinterleave(const short *in, int stride, int channel, float *out, int frames) {
+    if (!in) {
+        memset(out, 0, frames * sizeof(float));
+        return;
+    }
+    in += channel;
+    for (int i = 0; i < frames; i++) {
+        out[i] = in[(size_t)i * stride] * (1.0f / 32768.0f);
+    }
+}
+
+static void deinterleave_i16(const short *in, int stride, int channel, short *out, int frames) {
+    if (!in) {
+        memset(out, 0, frames * sizeof(short));
+        return;
+    }
+    in += channel;
+    for (int i = 0; i < frames; i++) {
+        out[i] = in[(size_t)i * stride];
+    }
+}
+
+static void run_channel_pcm(ChannelPipeline *p, int ch) {
+    size_t offset = (size_t)ch * p->blockFrames;
+    short *x = p->x16 + offset;
+
+    deinterleave_i16(p->noisy, p->channels, ch, p->d16 + offset, p->frames);
+    if (p->refChannels == p->channels) {
+        deinterleave_i16(p->noise, p->refChannels, ch, x, p->frames);
+    } else {
+        x = p->x16;
+    }
+
+    anc_engine_process_i16(p->engines[ch], x, p->d16 + offset, p->e16 + offset, p->frames);
+}
+
+static void run_channel(void *arg) {
+    ChannelJob *job = (ChannelJob *)arg;
+    ChannelPipeline *p = job->pipeline;
+    int ch = job->channel;
+
+    if (p->pcmPlanes) {
+        run_channel_pcm(p, ch);
+        return;
+    }
+
+    size_t offset = (size_t)ch * p->blockFrames;
+    float *x = p->x + offset;
+
+    deinterleave(p->noisy, p->channels, ch, p->d + offset, p->frames);
+
+    // A mono reference is converted once by channel_pipeline_run() and shared
+    if (p->refChannels == p->channels) {
+        deinterleave(p->noise, p->refChannels, ch, x, p->frames);
+    } else {
+        x = p->x;
+    }
+
+    anc_engine_process(p->engines[ch], x, p->d + offset, p->e + offset, p->frames);
+}
+
+int channel_pipeline_init(ChannelPipeline *p, int channels, int refChannels, int blockFrames,
+                          ANCEngine **engines, ThreadPool *pool) {
+    memset(p, 0, sizeof(*p));
+    if (channels <= 0 || (refChannels != channels && refChannels != 1)) return -1;
+
+    p->channels = channels;
+    p->refChannels = refChannels;
+    p->blockFrames = blockFrames;
+    p->engines = engines;
+    p->pcmPlanes = anc_engine_native_i16(engines[0]);
+    p->pool = pool;
+
+    size_t planeSize = (size_t)channels * blockFrames * (p->pcmPlanes ? sizeof(short) : sizeof(float));
+    void *x = malloc(planeSize), *d = malloc(planeSize), *e = malloc(planeSize);
+    p->jobs = (ChannelJob *)malloc(channels * sizeof(ChannelJob));
+    if (!p->pcmPlanes && channels > 1) p->row = (short *)malloc(blockFrames * sizeof(short));
+    if (p->pcmPlanes) {
+        p->x16 = (short *)x;
+        p->d16 = (short *)d;
+        p->e16 = (short *)e;
+    } else {
+        p->x = (float *)x;
+        p->d = (float *)d;
+        p->e = (float *)e;
+    }
+    if (!x || !d || !e || !p->jobs || (!p->pcmPlanes && channels > 1 && !p->row)) {
+        channel_pipeline_free(p);
+        return -1;
+    }
+
+    for (int ch = 0; ch < channels; ch++) {
+        p->jobs[ch].pipeline = p;
+        p->jobs[ch].channel = ch;
+    }
+    return 0;
+}
+
+void channel_pipeline_free(ChannelPipeline *p) {
+    free(p->x);
+    free(p->d);
+    free(p->e);
+    free(p->x16);
+    free(p->d16);
+    free(p->e16);
+    free(p->row);
+    free(p->jobs);
+    p->x = p->d = p->e = NULL;
+    p->x16 = p->d16 = p->e16 = p->row = NULL;
+    p->jobs = NULL;
+}
+
+void channel_pipeline_run(ChannelPipeline *p, const short *noisy, const short *noise, int frames) {
+    p->noisy = noisy;
+    p->noise = noise;
+    p->frames = frames;
+
+    if (p->refChannels != p->channels) {
+        if (p->pcmPlanes) deinterleave_i16(noise, 1, 0, p->x16, frames);
+        else deinterleave(noise, 1, 0, p->x, frames);
+    }
+
+    if (!p->pool || p->channels == 1) {
+        for (int ch = 0; ch < p->channels; ch++) run_channel(&p->jobs[ch]);
+        return;
+    }
+
+    for (int ch = 0; ch < p->channels; ch++) {
+        if (thread_pool_submit(p->pool, run_channel, &p->jobs[ch]) != 0) {
+            run_channel(&p->jobs[ch]);
+        }
+    }
+    thread_pool_wait(p->pool);
+}
+
+void channel_pipeline_interleave(const ChannelPipeline *p, int first, int frames, short *out) {
+    if (p->pcmPlanes) {
+        for (int ch = 0; ch < p->channels; ch++) {
+            const short *plane = p->e16 + (size_t)ch * p->blockFrames + first;
+            for (int i = 0; i < frames; i++) out[(size_t)i * p->channels + ch] = plane[i];
+        }
+        return;
+    }
+
+    // Mono output converts straight into place
+    if (p->channels == 1) {
+        anc_float_to_pcm(p->e + first, out, frames);
+        return;
+    }
+
+    // Otherwise each plane is converted into the row, then interleaved
+    for (int ch = 0; ch < p->channels; ch++) {
+        anc_float_to_pcm(p->e + (size_t)ch * p->blockFrames + first, p->row, frames);
+        for (int i = 0; i < frames; i++) out[(size_t)i * p->channels + ch] = p->row[i];
+    }
+}
@@ -0,0 +1,64 @@
+// Per-channel processing of interleaved 16-bit PCM.
+//
+// Each block is split into one float plane per channel (int16 planes for
+// engines that work on 16-bit PCM natively) and every channel is run
+// through its own engine, one pool task per channel. The noise reference
+// either has the same channel count as the noisy input or is mono, in which
+// case it is shared by all channels. Deinterleaving happens inside the
+// channel tasks so the conversion is spread over the workers as well.
+#ifndef CHANNEL_PIPELINE_H
+#define CHANNEL_PIPELINE_H
+
+#include "thread_pool.h"
+#include "anc_engine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ChannelPipeline;
+
+typedef struct {
+    struct ChannelPipeline *pipeline;
+    int channel;
+} ChannelJob;
+
+typedef struct ChannelPipeline {
+    int channels;
+    int refChannels;          // 1 (shared reference) or channels
+    int blockFrames;
+    ANCEngine **engines;      // One engine per channel, all of the same type
+    int pcmPlanes;            // Non-zero: the engines get 16-bit planes
+    ThreadPool *pool;         // NULL runs every channel in the calling thread
+    float *x;                 // Reference planes, blockFrames per channel
+    float *d;                 // Noisy planes
+    float *e;                 // Cleaned planes
+    short *x16, *d16, *e16;   // The same planes for a 16-bit engine
+    short *row;               // One cleaned float plane as 16-bit PCM, for interleaving
+    ChannelJob *jobs;
+
+    // Block being processed
+    const short *noisy;
+    const short *noise;
+    int frames;
+} ChannelPipeline;
+
+// Returns 0 on success, -1 for an unsupported reference layout or when the
+// planes could not be allocated. The engines stay owned by the caller.
+int channel_pipeline_init(ChannelPipeline *p, int channels, int refChannels, int blockFrames,
+                          ANCEngine **engines, ThreadPool *pool);
+void channel_pipeline_free(ChannelPipeline *p);
+
+// Filter `frames` (<= blockFrames) interleaved frames. A NULL input is
+// treated as silence, which is how filter latency is flushed at the end.
+void channel_pipeline_run(ChannelPipeline *p, const short *noisy, const short *noise, int frames);
+
+// Convert frames [first, first + frames) of the last block back to
+// interleaved 16-bit PCM
+void channel_pipeline_interleave(const ChannelPipeline *p, int first, int frames, short *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHANNEL_PIPELINE_H
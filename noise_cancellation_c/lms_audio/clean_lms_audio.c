@@ -1,93 +1,522 @@
-#include <stdio.h>
-#include <stdlib.h>
-
-#define N 128   // Number of filter coefficients
-#define MU 0.01 // Step size
-
-// WAV file header (44 bytes)
-typedef struct {
-    char chunkID[4];
-    int chunkSize;
-    char format[4];
-    char subchunk1ID[4];
-    int subchunk1Size;
-    short audioFormat;
-    short numChannels;
-    int sampleRate;
-    int byteRate;
-    short blockAlign;
-    short bitsPerSample;
-    char subchunk2ID[4];
-    int subchunk2Size;
-} WAVHeader;
-
-void adaptive_noise_cancellation(short *x, short *d, float *w, short *e, int length) {
-    float y;
-    
-    for (int n = N - 1; n < length; n++) {
-        y = 0.0;
-        
-        // Compute filter output (estimated noise)
-        for (int i = 0; i < N; i++) {
-            y += w[i] * x[n - i];
-        }
-
-        e[n] = d[n] - (short)y; // Error signal (clean audio)
-
-        // Update filter weights
-        for (int i = 0; i < N; i++) {
-            w[i] += MU * e[n] * x[n - i];
-        }
-    }
-}
-
-int main() {
-    FILE *noisyFile, *noiseFile, *outputFile;
-    WAVHeader header;
-
-    // Open noisy WAV file
-    noisyFile = fopen("D:\\Downloads\\noise_cancellation_c\\lms_audio\\noisy_audio.wav", "rb");
-    noiseFile = fopen("converted_audio.wav", "rb");
-
-    if (!noisyFile || !noiseFile) {
-        printf("Error opening input files!\n");
-        return -1;
-    }
-
-    // Read WAV header
-    fread(&header, sizeof(WAVHeader), 1, noisyFile);
-    fseek(noiseFile, 44, SEEK_SET); // Skip header for noise file
-
-    // Calculate number of samples
-    int length = header.subchunk2Size / (header.bitsPerSample / 8);
-
-    // Allocate memory
-    short *noisySignal = (short *)malloc(length * sizeof(short));
-    short *noiseSignal = (short *)malloc(length * sizeof(short));
-    short *filteredSignal = (short *)malloc(length * sizeof(short));
-    float w[N] = {0}; // Adaptive filter weights
-
-    // Read audio samples
-    fread(noisySignal, sizeof(short), length, noisyFile);
-    fread(noiseSignal, sizeof(short), length, noiseFile);
-
-    fclose(noisyFile);
-    fclose(noiseFile);
-
-    // Apply LMS noise cancellation
-    adaptive_noise_cancellation(noiseSignal, noisySignal, w, filteredSignal, length);
-
-    // Write cleaned output as WAV
-    outputFile = fopen("cleaned_audio.wav", "wb");
-    fwrite(&header, sizeof(WAVHeader), 1, outputFile); // Write WAV header
-    fwrite(filteredSignal, sizeof(short), length, outputFile);
-    fclose(outputFile);
-
-    // Cleanup
-    free(noisySignal);
-    free(noiseSignal);
-    free(filteredSignal);
-
-    printf("Noise removed! Output saved as 'cleaned_audio.wav'.\n");
-    return 0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "wav_io.h"
+#include "anc_engine.h"
+#include "anc_metrics.h"
+#include "fft.h"
+#include "channel_pipeline.h"
+
+#define FRAME_SIZE 1024 // Samples processed per block
+#define BLOCK_FRAMES 8192 // Frames per pipeline block; channels run in parallel within one
+
+// Quality metrics of the written output against the input it came from
+typedef struct {
+    ANCMetrics metrics;
+    const short *noisy;   // Interleaved, aligned with the output
+    const short *clean;   // NULL without --clean
+    size_t written;       // Frames written so far
+} Meter;
+
+// Measured straight from the 16-bit samples: converting three streams to
+// float would cost more than the filtering of the cheaper engines
+static int measure_block(Meter *meter, const short *outBlock, int frames, int channels) {
+    size_t first = meter->written * channels;
+    const short *clean = meter->clean ? meter->clean + first : NULL;
+
+    meter->written += frames;
+    return anc_metrics_push_i16(&meter->metrics, meter->noisy + first, outBlock, clean, frames * channels);
+}
+
+// Write the part of a cleaned block that lies past the filter latency, and
+// measure it when there is a meter
+static int write_block(FILE *file, const ChannelPipeline *p, short *outBlock, int frames, int *skip, Meter *meter) {
+    int drop = *skip < frames ? *skip : frames;
+    size_t count = (size_t)(frames - drop) * p->channels;
+
+    *skip -= drop;
+    channel_pipeline_interleave(p, drop, frames - drop, outBlock);
+    if (fwrite(outBlock, sizeof(short), count, file) != count) return -1;
+    return meter && count > 0 ? measure_block(meter, outBlock, frames - drop, p->channels) : 0;
+}
+
+typedef struct {
+    const char *mode;  // Engine name
+    int taps;          // 0: engine default
+    float mu;          // 0: engine default
+    double lambda;     // 0: engine default, RLS engines only
+    double delta;      // 0: engine default, RLS engines only
+    int threads;       // 0: one per channel (single file) or per CPU (batch)
+    int pin;           // Pin batch workers to CPUs
+    int metrics;       // Write quality metrics to <output>.json
+    const char *cleanPath; // Clean signal for the SNR metrics, single file only
+} Options;
+
+// Name the engine and, when the tap count breaks a limit of its registry
+// entry, that limit
+static void report_setup_error(const Options *opt) {
+    const ANCEngineType *type = anc_engine_find(opt->mode);
+    int taps = opt->taps > 0 ? opt->taps : type->defaultTaps;
+
+    printf("Error: Cannot set up the %s filter with %d taps", type->name, taps);
+    if (type->maxTaps > 0 && taps > type->maxTaps) {
+        printf(" (%s takes at most %d)", type->name, type->maxTaps);
+    } else if ((type->flags & ANC_POWER_OF_TWO) && (taps & (taps - 1)) != 0) {
+        printf(" (%s takes a power of two)", type->name);
+    }
+    printf("\n");
+}
+
+// One (noisy, noise, output) triple and what processing it produced
+typedef struct {
+    const Options *opt;
+    char *noisyPath;
+    char *noisePath;
+    char *outputPath;
+    long long bytes;      // Size of the noisy file, used to schedule long clips first
+    int status;
+    size_t frames;
+    int channels;
+    int sampleRate;
+    ANCMetricsResult quality;  // With --metrics
+} CleanJob;
+
+typedef struct {
+    CleanJob *items;
+    int count;
+    int capacity;
+} JobList;
+
+// Clean one recording. threads > 1 spreads its channels over a private pool.
+static int clean_file(CleanJob *job, int threads) {
+    const Options *opt = job->opt;
+    WAVFile noisyWav, noiseWav;
+
+    // Map both input files
+    if (wav_open(job->noisyPath, &noisyWav) != 0) return -1;
+    if (wav_open(job->noisePath, &noiseWav) != 0) {
+        wav_close(&noisyWav);
+        return -1;
+    }
+
+    const short *noisySignal = wav_samples_i16(&noisyWav);
+    const short *noiseSignal = wav_samples_i16(&noiseWav);
+    if (!noisySignal || !noiseSignal) {
+        printf("Error: %s: Only 16-bit PCM WAV files are supported!\n", job->noisyPath);
+        wav_close(&noisyWav);
+        wav_close(&noiseWav);
+        return -1;
+    }
+
+    int channels = noisyWav.fmt.numChannels;
+    int refChannels = noiseWav.fmt.numChannels;
+    if (refChannels != channels && refChannels != 1) {
+        printf("Error: %s: The noise reference must be mono or have %d channels (got %d)\n",
+               job->noisePath, channels, refChannels);
+        wav_close(&noisyWav);
+        wav_close(&noiseWav);
+        return -1;
+    }
+
+    // Process the overlapping part of both recordings
+    size_t length = noisyWav.numFrames < noiseWav.numFrames ? noisyWav.numFrames : noiseWav.numFrames;
+
+    // One independent engine per channel; only the filter states and one
+    // block of planes stay resident
+    ANCEngine **engines = (ANCEngine **)calloc(channels, sizeof(ANCEngine *));
+    short *outBlock = (short *)malloc((size_t)BLOCK_FRAMES * channels * sizeof(short));
+    int ready = 0;
+    if (engines && outBlock) {
+        for (; ready < channels; ready++) {
+            engines[ready] = anc_engine_create_tuned(opt->mode, opt->taps, opt->mu, opt->lambda, opt->delta, FRAME_SIZE);
+            if (!engines[ready]) break;
+        }
+    }
+
+    ChannelPipeline pipeline;
+    if (ready != channels ||
+        channel_pipeline_init(&pipeline, channels, refChannels, BLOCK_FRAMES, engines, NULL) != 0) {
+        report_setup_error(opt);
+        for (int ch = 0; ch < ready; ch++) anc_engine_destroy(engines[ch]);
+        free(engines);
+        free(outBlock);
+        wav_close(&noisyWav);
+        wav_close(&noiseWav);
+        return -1;
+    }
+
+    if (threads > channels) threads = channels;
+    if (threads > 1) pipeline.pool = thread_pool_create(threads, 0);
+
+    int status = 0;
+    Meter meterState, *meter = NULL;
+    WAVFile cleanWav;
+    int cleanOpen = 0;
+    if (opt->metrics) {
+        meter = &meterState;
+        memset(meter, 0, sizeof(*meter));
+        meter->noisy = noisySignal;
+        if (opt->cleanPath) {
+            cleanOpen = wav_open(opt->cleanPath, &cleanWav) == 0;
+            meter->clean = cleanOpen ? wav_samples_i16(&cleanWav) : NULL;
+            if (!meter->clean || cleanWav.fmt.numChannels != channels || cleanWav.numFrames < length) {
+                printf("Error: %s: The clean signal must be 16-bit PCM with %d channel(s) and %zu frames\n",
+                       opt->cleanPath, channels, length);
+                status = -1;
+            }
+        }
+        if (status == 0 && anc_metrics_init(&meter->metrics, noisyWav.fmt.sampleRate, channels, 0.0,
+                                            meter->clean != NULL) != 0) {
+            printf("Error: %s: Unsupported sample rate\n", job->noisyPath);
+            status = -1;
+        }
+    }
+
+    FILE *outputFile = status == 0 ? fopen(job->outputPath, "wb") : NULL;
+    if (outputFile) {
+        status = wav_write_header(outputFile, &noisyWav.fmt, length * noisyWav.fmt.blockAlign);
+    } else if (status == 0) {
+        printf("Error creating output file %s\n", job->outputPath);
+        status = -1;
+    }
+
+    int skip = engines[0]->latency;
+
+    // Apply noise cancellation block by block, all channels of a block in parallel
+    for (size_t pos = 0; pos < length && status == 0; pos += BLOCK_FRAMES) {
+        int frames = (int)(length - pos < BLOCK_FRAMES ? length - pos : BLOCK_FRAMES);
+
+        channel_pipeline_run(&pipeline, noisySignal + pos * channels, noiseSignal + pos * refChannels, frames);
+        status = write_block(outputFile, &pipeline, outBlock, frames, &skip, meter);
+    }
+
+    // Push silence through to drain samples still held back by the latency
+    int pending = engines[0]->latency;
+    while (pending > 0 && status == 0) {
+        int frames = pending < BLOCK_FRAMES ? pending : BLOCK_FRAMES;
+        channel_pipeline_run(&pipeline, NULL, NULL, frames);
+        status = write_block(outputFile, &pipeline, outBlock, frames, &skip, meter);
+        pending -= frames;
+    }
+
+    if (outputFile) {
+        if (fclose(outputFile) != 0) status = -1;
+        if (status != 0) printf("Error writing output file %s\n", job->outputPath);
+    }
+
+    // The metrics go next to the output as <output>.json
+    if (meter) {
+        if (status == 0) {
+            char path[4096];
+            snprintf(path, sizeof(path), "%s.json", job->outputPath);
+            anc_metrics_result(&meter->metrics, &job->quality);
+            if (anc_metrics_write_json(&job->quality, path) != 0) {
+                printf("Error writing metrics file %s\n", path);
+                status = -1;
+            }
+        }
+        anc_metrics_free(&meter->metrics);
+    }
+    if (cleanOpen) wav_close(&cleanWav);
+
+    job->frames = length;
+    job->channels = channels;
+    job->sampleRate = noisyWav.fmt.sampleRate;
+
+    // Cleanup
+    thread_pool_destroy(pipeline.pool);
+    channel_pipeline_free(&pipeline);
+    for (int ch = 0; ch < channels; ch++) anc_engine_destroy(engines[ch]);
+    free(engines);
+    free(outBlock);
+    wav_close(&noisyWav);
+    wav_close(&noiseWav);
+    return status;
+}
+
+static char *copy_string(const char *text) {
+    size_t size = strlen(text) + 1;
+    char *copy = (char *)malloc(size);
+    if (copy) memcpy(copy, text, size);
+    return copy;
+}
+
+static int job_list_add(JobList *list, const Options *opt, const char *noisy, const char *noise, const char *output) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? 2 * list->capacity : 256;
+        CleanJob *grown = (CleanJob *)realloc(list->items, capacity * sizeof(CleanJob));
+        if (!grown) return -1;
+        list->items = grown;
+        list->capacity = capacity;
+    }
+
+    CleanJob *job = &list->items[list->count];
+    memset(job, 0, sizeof(*job));
+    job->opt = opt;
+    job->noisyPath = copy_string(noisy);
+    job->noisePath = copy_string(noise);
+    job->outputPath = copy_string(output);
+    if (!job->noisyPath || !job->noisePath || !job->outputPath) {
+        free(job->noisyPath);
+        free(job->noisePath);
+        free(job->outputPath);
+        return -1;
+    }
+
+    struct stat info;
+    job->bytes = stat(noisy, &info) == 0 ? (long long)info.st_size : 0;
+    list->count++;
+    return 0;
+}
+
+static void job_list_free(JobList *list) {
+    for (int i = 0; i < list->count; i++) {
+        free(list->items[i].noisyPath);
+        free(list->items[i].noisePath);
+        free(list->items[i].outputPath);
+    }
+    free(list->items);
+}
+
+// Manifest: one "noisy noise output" triple per line, '#' starts a comment
+static int load_manifest(const char *path, const Options *opt, JobList *list) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        printf("Error opening manifest %s\n", path);
+        return -1;
+    }
+
+    char line[3 * 1024];
+    char noisy[1024], noise[1024], output[1024];
+    int lineNumber = 0;
+    int status = 0;
+    while (status == 0 && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        int fields = sscanf(line, "%1023s %1023s %1023s", noisy, noise, output);
+        if (fields <= 0) continue;
+        if (fields != 3) {
+            printf("Error: %s:%d: expected <noisy> <noise> <output>\n", path, lineNumber);
+            status = -1;
+        } else {
+            status = job_list_add(list, opt, noisy, noise, output);
+        }
+    }
+
+    fclose(file);
+    return status;
+}
+
+// Directory: every <name>.noisy.wav with a matching <name>.noise.wav is
+// cleaned into <name>.clean.wav next to it
+static int scan_directory(const char *path, const Options *opt, JobList *list) {
+    static const char suffix[] = ".noisy.wav";
+    size_t suffixLength = sizeof(suffix) - 1;
+
+    DIR *dir = opendir(path);
+    if (!dir) {
+        printf("Error opening directory %s\n", path);
+        return -1;
+    }
+
+    struct dirent *entry;
+    char noisy[4096], noise[4096], output[4096];
+    int status = 0;
+    while (status == 0 && (entry = readdir(dir)) != NULL) {
+        size_t length = strlen(entry->d_name);
+        if (length <= suffixLength || strcmp(entry->d_name + length - suffixLength, suffix) != 0) continue;
+
+        int stem = (int)(length - suffixLength);
+        snprintf(noisy, sizeof(noisy), "%s/%s", path, entry->d_name);
+        snprintf(noise, sizeof(noise), "%s/%.*s.noise.wav", path, stem, entry->d_name);
+        snprintf(output, sizeof(output), "%s/%.*s.clean.wav", path, stem, entry->d_name);
+
+        struct stat info;
+        if (stat(noise, &info) != 0) {
+            printf("Skipping %s: no %.*s.noise.wav\n", entry->d_name, stem, entry->d_name);
+            continue;
+        }
+        status = job_list_add(list, opt, noisy, noise, output);
+    }
+
+    closedir(dir);
+    return status;
+}
+
+static int longest_first(const void *a, const void *b) {
+    long long x = ((const CleanJob *)a)->bytes;
+    long long y = ((const CleanJob *)b)->bytes;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static void run_job(void *arg) {
+    CleanJob *job = (CleanJob *)arg;
+    job->status = clean_file(job, 1);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Clean every triple of a manifest or directory on one work-stealing pool.
+// Files are the unit of work, so a file's channels run in its own task.
+static int run_batch(const char *source, const Options *opt) {
+    JobList list = {0};
+    struct stat info;
+
+    int status = stat(source, &info) == 0 && S_ISDIR(info.st_mode)
+                     ? scan_directory(source, opt, &list)
+                     : load_manifest(source, opt, &list);
+    if (status != 0 || list.count == 0) {
+        if (status == 0) printf("Error: No recordings found in %s\n", source);
+        job_list_free(&list);
+        return -1;
+    }
+
+    // Shared tables (FFT plans) are built without locking, so before the workers start
+    if (anc_engine_prepare(anc_engine_find(opt->mode), opt->taps) != 0) {
+        report_setup_error(opt);
+        job_list_free(&list);
+        return -1;
+    }
+
+    // Longest clips first so the short ones fill in the gaps at the end
+    qsort(list.items, list.count, sizeof(CleanJob), longest_first);
+
+    ThreadPool *pool = thread_pool_create(opt->threads, opt->pin ? THREAD_POOL_PIN : 0);
+    if (!pool) {
+        printf("Error: Cannot start worker threads\n");
+        job_list_free(&list);
+        return -1;
+    }
+
+    double start = now_seconds();
+    for (int i = 0; i < list.count; i++) {
+        if (thread_pool_submit(pool, run_job, &list.items[i]) != 0) run_job(&list.items[i]);
+    }
+    thread_pool_wait(pool);
+    double elapsed = now_seconds() - start;
+
+    int failed = 0;
+    double audioSeconds = 0.0, samples = 0.0;
+    for (int i = 0; i < list.count; i++) {
+        const CleanJob *job = &list.items[i];
+        if (job->status != 0) {
+            failed++;
+            continue;
+        }
+        samples += (double)job->frames * job->channels;
+        if (job->sampleRate > 0) audioSeconds += (double)job->frames / job->sampleRate;
+    }
+    if (elapsed <= 0.0) elapsed = 1e-9;
+
+    printf("Batch: %d file(s), %d failed, %d thread(s)%s, %ld steal(s)\n", list.count, failed,
+           thread_pool_size(pool), opt->pin ? " pinned" : "", thread_pool_steals(pool));
+    printf("Processed %.1f s of audio in %.2f s: %.1fx real time, %.2f Msamples/s, %.1f files/s\n",
+           audioSeconds, elapsed, audioSeconds / elapsed, samples / elapsed * 1e-6, list.count / elapsed);
+
+    thread_pool_destroy(pool);
+    job_list_free(&list);
+    return failed ? -1 : 0;
+}
+
+// Parse leading --options; returns the index of the first positional argument
+// or -1 on an unknown option
+static int parse_options(int argc, char *argv[], int arg, Options *opt) {
+    while (arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        if (strcmp(argv[arg], "--pin") == 0) {
+            opt->pin = 1;
+            arg++;
+            continue;
+        }
+        if (strcmp(argv[arg], "--metrics") == 0) {
+            opt->metrics = 1;
+            arg++;
+            continue;
+        }
+        if (arg + 1 >= argc) return -1;
+
+        if (strcmp(argv[arg], "--taps") == 0) {
+            opt->taps = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--mu") == 0) {
+            opt->mu = (float)atof(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--lambda") == 0) {
+            opt->lambda = atof(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--delta") == 0) {
+            opt->delta = atof(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--clean") == 0) {
+            opt->cleanPath = argv[arg + 1];
+            opt->metrics = 1;
+        } else if (strcmp(argv[arg], "--threads") == 0) {
+            opt->threads = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--mode") == 0) {
+            if (!anc_engine_find(argv[arg + 1])) return -1;
+            opt->mode = argv[arg + 1];
+        } else {
+            return -1;
+        }
+        arg += 2;
+    }
+
+    int valid = opt->taps >= 0 && opt->mu >= 0.0f && opt->lambda >= 0.0 && opt->lambda <= 1.0 && opt->delta >= 0.0;
+    return valid ? arg : -1;
+}
+
+int main(int argc, char *argv[]) {
+    Options opt = {"lms", 0, 0.0f, 0.0, 0.0, 0, 0, 0, NULL}; // Engine defaults unless --taps/--mu/... are given
+    int status;
+
+    if (argc > 1 && strcmp(argv[1], "batch") == 0) {
+        int arg = parse_options(argc, argv, 2, &opt);
+        if (arg < 0 || argc - arg != 1 || opt.cleanPath) {
+            printf("Usage: %s batch [--mode %s] [--taps N] [--mu MU] [--lambda L] [--delta D] [--threads N] [--pin] [--metrics] <manifest|directory>\n",
+                   argv[0], anc_engine_names("|"));
+            return 1;
+        }
+        status = run_batch(argv[arg], &opt);
+        fft_plan_cache_free();
+        return status;
+    }
+
+    char noisyPath[] = "noisy_audio.wav";
+    char noisePath[] = "converted_audio.wav";
+    char outputPath[] = "cleaned_audio.wav";
+    CleanJob job = {.opt = &opt, .noisyPath = noisyPath, .noisePath = noisePath, .outputPath = outputPath};
+
+    int arg = parse_options(argc, argv, 1, &opt);
+    if (arg >= 0 && argc - arg == 3) {
+        job.noisyPath = argv[arg];
+        job.noisePath = argv[arg + 1];
+        job.outputPath = argv[arg + 2];
+    } else if (arg < 0 || argc != arg) {
+        printf("Usage: %s [--mode %s] [--taps N] [--mu MU] [--lambda L] [--delta D] [--threads N] [--metrics] [--clean clean.wav] [<noisy.wav> <noise.wav> <output.wav>]\n",
+               argv[0], anc_engine_names("|"));
+        printf("       %s batch [options] [--pin] <manifest|directory>\n", argv[0]);
+        return 1;
+    }
+
+    // By default every channel gets its own worker, up to the CPU count
+    int threads = opt.threads > 0 ? opt.threads : cpu_count();
+    status = clean_file(&job, threads);
+    fft_plan_cache_free();
+    if (status != 0) return -1;
+
+    printf("Noise removed from %d channel(s)! Output saved as '%s'.\n", job.channels, job.outputPath);
+    if (opt.metrics) {
+        printf("ERLE %.2f dB", job.quality.erle);
+        if (job.quality.hasClean) {
+            printf(", SNR %.2f dB (input %.2f dB), segmental SNR %.2f dB", job.quality.snr, job.quality.inputSnr,
+                   job.quality.segmentalSnr);
+        }
+        if (job.quality.convergence >= 0.0) printf(", converged after %.2f s", job.quality.convergence);
+        printf("; saved as '%s.json'\n", job.outputPath);
+    }
+    return 0;
+}
@@ -1,82 +1,270 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-#include "sndfile.h"  // For audio file handling
-
-#define N 128   // Number of filter coefficients
-#define MU 0.01 // Step size
-
-void adaptive_noise_cancellation(float *x, float *d, float *w, float *e, int length) {
-    float y;
-    
-    for (int n = N - 1; n < length; n++) {
-        y = 0.0;
-        
-        // Compute filter output (estimated noise)
-        for (int i = 0; i < N; i++) {
-            y += w[i] * x[n - i];
-        }
-
-        e[n] = d[n] - y; // Error signal (clean audio)
-
-        // Update filter weights
-        for (int i = 0; i < N; i++) {
-            w[i] += MU * e[n] * x[n - i];
-        }
-    }
-}
-
-int main() {
-    // File input/output variables
-    SNDFILE *inputFile, *noiseFile, *outputFile;
-    SF_INFO sfinfo;
-
-    // Open noisy audio file
-    inputFile = sf_open("noisy_audio.wav", SFM_READ, &sfinfo);
-    if (!inputFile) {
-        printf("Error opening noisy audio file!\n");
-        return -1;
-    }
-
-    // Open noise reference file
-    noiseFile = sf_open("noise_signal.wav", SFM_READ, &sfinfo);
-    if (!noiseFile) {
-        printf("Error opening noise reference file!\n");
-        sf_close(inputFile);
-        return -1;
-    }
-
-    // Allocate memory for audio processing
-    int length = sfinfo.frames;
-    float *noisySignal = (float *)malloc(length * sizeof(float));
-    float *noiseSignal = (float *)malloc(length * sizeof(float));
-    float *filteredSignal = (float *)malloc(length * sizeof(float));
-    float w[N] = {0}; // Adaptive filter weights
-
-    // Read audio samples
-    sf_readf_float(inputFile, noisySignal, length);
-    sf_readf_float(noiseFile, noiseSignal, length);
-
-    // Apply Adaptive Noise Cancellation (ANC)
-    adaptive_noise_cancellation(noiseSignal, noisySignal, w, filteredSignal, length);
-
-    // Write output cleaned audio
-    outputFile = sf_open("cleaned_audio.wav", SFM_WRITE, &sfinfo);
-    if (!outputFile) {
-        printf("Error creating output file!\n");
-        return -1;
-    }
-
-    sf_writef_float(outputFile, filteredSignal, length);
-
-    // Clean up
-    sf_close(inputFile);
-    sf_close(noiseFile);
-    sf_close(outputFile);
-    free(noisySignal);
-    free(noiseSignal);
-    free(filteredSignal);
-
-    printf("Cleaned audio saved as 'cleaned_audio.wav'.\n");
-    return 0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include "sndfile.h"  // For audio file handling
+#include "anc_engine.h"
+#include "delay_tracker.h"
+#include "fft.h"
+
+#define N 128           // Number of filter coefficients
+#define FRAME_SIZE 1024 // Frames read per block
+#define MAX_DELAY 1.0f  // Largest bulk delay --align looks for, in seconds
+#define ALIGN_LEAD (N / 8) // Frames the aligned reference is left ahead of the primary
+
+// Frames the reference is delayed by at a primary frame: the estimated lag
+// less ALIGN_LEAD, plus the fixed primary delay that keeps it non-negative
+static long long reference_delay(const DelayTracker *tracker, long long frame, long long primaryDelay) {
+    return primaryDelay + (long long)lrintf(delay_tracker_delay_at(tracker, frame)) - ALIGN_LEAD;
+}
+
+// Read up to `frames` frames into a ring of ringFrames frames, wrapping at the end
+static sf_count_t read_ring(SNDFILE *file, float *ring, long long ringFrames, long long at, int channels,
+                            sf_count_t frames) {
+    sf_count_t total = 0;
+    while (total < frames) {
+        long long slot = (at + total) % ringFrames;
+        sf_count_t chunk = frames - total;
+        if (chunk > ringFrames - slot) chunk = ringFrames - slot;
+        sf_count_t got = sf_readf_float(file, ring + slot * channels, chunk);
+        if (got <= 0) break;
+        total += got;
+    }
+    return total;
+}
+
+// Write the part of a filtered block that lies past `*skip` frames
+static void write_trimmed(SNDFILE *outputFile, const float *filtered, int channels, int frames, long long *skip) {
+    int drop = *skip < frames ? (int)*skip : frames;
+    *skip -= drop;
+    if (frames > drop) sf_writef_float(outputFile, filtered + (size_t)drop * channels, frames - drop);
+}
+
+// Estimate the delay track in a first pass, then run the filter on a
+// reference shifted to sit ALIGN_LEAD frames ahead of the primary. When the
+// primary leads the reference the primary is delayed as well, and the
+// output is trimmed by the same amount, plus the engine latency, so it
+// stays aligned with the input.
+static int clean_aligned(SNDFILE *inputFile, SNDFILE *noiseFile, SNDFILE *outputFile, const SF_INFO *info,
+                         ANCEngine *engine) {
+    int channels = info->channels;
+    long long latencyFrames = engine->latency / channels;
+    float *noisy = (float *)malloc((size_t)FRAME_SIZE * channels * sizeof(float));
+    float *noise = (float *)malloc((size_t)FRAME_SIZE * channels * sizeof(float));
+    DelayTracker tracker;
+    if (!noisy || !noise || delay_tracker_init(&tracker, info->samplerate, channels, MAX_DELAY) != 0) {
+        printf("Error: Out of memory\n");
+        free(noisy);
+        free(noise);
+        return -1;
+    }
+
+    // Pass 1: the delay track
+    sf_count_t noisyFrames, noiseFrames;
+    while ((noisyFrames = sf_readf_float(inputFile, noisy, FRAME_SIZE)) > 0) {
+        noiseFrames = sf_readf_float(noiseFile, noise, noisyFrames);
+        if (noiseFrames <= 0) break;
+        delay_tracker_push(&tracker, noisy, noise, (int)noiseFrames);
+    }
+    delay_tracker_finish(&tracker);
+
+    long long frames = (long long)info->frames;
+    long long lowest = 0, highest = 0;
+    for (int i = 0; i < tracker.count; i++) {
+        long long shift = (long long)lrintf(tracker.estimates[i].delay) - ALIGN_LEAD;
+        if (i == 0 || shift < lowest) lowest = shift;
+        if (i == 0 || shift > highest) highest = shift;
+    }
+    if (tracker.count == 0) lowest = highest = -ALIGN_LEAD;
+    long long primaryDelay = lowest < 0 ? -lowest : 0;
+    long long maxDelay = primaryDelay + highest;
+
+    printf("Delay: %.1f frames at the start, %.1f at the end (%d of %d windows confident)\n",
+           delay_tracker_delay_at(&tracker, 0), delay_tracker_delay_at(&tracker, frames), tracker.count,
+           tracker.windows);
+
+    // Pass 2: filter through rings deep enough for the largest delay
+    long long ringFrames = maxDelay + 2 * FRAME_SIZE;
+    float *noisyRing = (float *)malloc((size_t)ringFrames * channels * sizeof(float));
+    float *noiseRing = (float *)malloc((size_t)ringFrames * channels * sizeof(float));
+    float *filtered = (float *)malloc((size_t)FRAME_SIZE * channels * sizeof(float));
+    int status = noisyRing && noiseRing && filtered ? 0 : -1;
+    if (status != 0) printf("Error: Out of memory\n");
+    if (status == 0 && (sf_seek(inputFile, 0, SEEK_SET) != 0 || sf_seek(noiseFile, 0, SEEK_SET) != 0)) {
+        printf("Error: Cannot rewind the input files\n");
+        status = -1;
+    }
+
+    // Stream time t holds primary frame t - primaryDelay, and its output
+    // comes out latencyFrames later
+    long long noisyRead = 0, noiseRead = 0, trim = primaryDelay + latencyFrames;
+    for (long long t = 0; status == 0 && t < frames + trim; t += FRAME_SIZE) {
+        int block = frames + trim - t < FRAME_SIZE ? (int)(frames + trim - t) : FRAME_SIZE;
+        if (noisyRead < t + block - primaryDelay) {
+            noisyRead += read_ring(inputFile, noisyRing, ringFrames, noisyRead, channels,
+                                   t + block - primaryDelay - noisyRead);
+        }
+        if (noiseRead < t + block) {
+            noiseRead += read_ring(noiseFile, noiseRing, ringFrames, noiseRead, channels, t + block - noiseRead);
+        }
+
+        // The track is close to linear over a block, so it is evaluated at
+        // the two ends only
+        long long first = t - primaryDelay;
+        double d0 = (double)reference_delay(&tracker, first, primaryDelay);
+        double d1 = (double)reference_delay(&tracker, first + block, primaryDelay);
+        for (int i = 0; i < block; i++) {
+            long long p = first + i;
+            long long r = t + i - (long long)floor(d0 + (d1 - d0) * i / block + 0.5);
+            for (int c = 0; c < channels; c++) {
+                noisy[i * channels + c] = p >= 0 && p < noisyRead ? noisyRing[(p % ringFrames) * channels + c] : 0.0f;
+                noise[i * channels + c] = r >= 0 && r < noiseRead ? noiseRing[(r % ringFrames) * channels + c] : 0.0f;
+            }
+        }
+
+        anc_engine_process(engine, noise, noisy, filtered, block * channels);
+
+        long long skip = t < trim ? trim - t : 0;
+        write_trimmed(outputFile, filtered, channels, block, &skip);
+    }
+
+    free(noisyRing);
+    free(noiseRing);
+    free(filtered);
+    free(noisy);
+    free(noise);
+    delay_tracker_free(&tracker);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    // --engine picks the filter (--nlms is short for --engine nlms, which
+    // normalizes the step by the reference energy); --align removes the bulk
+    // delay between the two files first
+    const char *mode = "lms";
+    int align = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--nlms") == 0) {
+            mode = "nlms";
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc && anc_engine_find(argv[i + 1])) {
+            mode = argv[++i];
+        } else if (strcmp(argv[i], "--align") == 0) {
+            align = 1;
+        } else {
+            printf("Usage: %s [--engine %s] [--nlms] [--align]\n", argv[0], anc_engine_names("|"));
+            return 1;
+        }
+    }
+
+    // File input/output variables
+    SNDFILE *inputFile, *noiseFile, *outputFile;
+    SF_INFO sfinfo, noiseInfo;
+
+    // Open noisy audio file
+    inputFile = sf_open("noisy_audio.wav", SFM_READ, &sfinfo);
+    if (!inputFile) {
+        printf("Error opening noisy audio file!\n");
+        return -1;
+    }
+
+    // Open noise reference file
+    noiseFile = sf_open("noise_signal.wav", SFM_READ, &noiseInfo);
+    if (!noiseFile) {
+        printf("Error opening noise reference file!\n");
+        sf_close(inputFile);
+        return -1;
+    }
+
+    if (noiseInfo.channels != sfinfo.channels) {
+        printf("Error: Noisy and noise reference files have different channel counts!\n");
+        sf_close(inputFile);
+        sf_close(noiseFile);
+        return -1;
+    }
+
+    // Open output before processing so cleaned audio is written as it is produced
+    outputFile = sf_open("cleaned_audio.wav", SFM_WRITE, &sfinfo);
+    if (!outputFile) {
+        printf("Error creating output file!\n");
+        sf_close(inputFile);
+        sf_close(noiseFile);
+        return -1;
+    }
+
+    // Memory use is fixed by the block size, not by the file length
+    int blockSamples = FRAME_SIZE * sfinfo.channels;
+    float *noisySignal = (float *)malloc(blockSamples * sizeof(float));
+    float *noiseSignal = (float *)malloc(blockSamples * sizeof(float));
+    float *filteredSignal = (float *)malloc(blockSamples * sizeof(float));
+    ANCEngine *engine = anc_engine_create(mode, N, 0.0f, blockSamples);
+
+    if (!noisySignal || !noiseSignal || !filteredSignal || !engine) {
+        printf("Error: Out of memory\n");
+        sf_close(inputFile);
+        sf_close(noiseFile);
+        sf_close(outputFile);
+        free(noisySignal);
+        free(noiseSignal);
+        free(filteredSignal);
+        anc_engine_destroy(engine);
+        return -1;
+    }
+
+    // The engine runs on the interleaved stream, so its delay has to be a
+    // whole number of frames to be trimmed off again
+    int latencyFrames = engine->latency / sfinfo.channels;
+    if (engine->latency % sfinfo.channels != 0) {
+        printf("Error: The %s engine delays by %d samples, not a whole number of %d-channel frames\n", mode,
+               engine->latency, sfinfo.channels);
+        sf_close(inputFile);
+        sf_close(noiseFile);
+        sf_close(outputFile);
+        free(noisySignal);
+        free(noiseSignal);
+        free(filteredSignal);
+        anc_engine_destroy(engine);
+        return -1;
+    }
+    if (latencyFrames > 0) {
+        printf("Engine latency: %d frames (%.2f ms), trimmed from the output\n", latencyFrames,
+               latencyFrames * 1e3 / sfinfo.samplerate);
+    }
+
+    // Apply Adaptive Noise Cancellation (ANC) one block at a time
+    int status = 0;
+    long long skip = latencyFrames;
+    sf_count_t noisyFrames, noiseFrames;
+    if (align) status = clean_aligned(inputFile, noiseFile, outputFile, &sfinfo, engine);
+    while (!align && (noisyFrames = sf_readf_float(inputFile, noisySignal, FRAME_SIZE)) > 0) {
+        noiseFrames = sf_readf_float(noiseFile, noiseSignal, noisyFrames);
+        if (noiseFrames <= 0) break;
+
+        int count = (int)noiseFrames * sfinfo.channels;
+        anc_engine_process(engine, noiseSignal, noisySignal, filteredSignal, count);
+        write_trimmed(outputFile, filteredSignal, sfinfo.channels, (int)noiseFrames, &skip);
+    }
+
+    // Push silence through to drain the frames still held back by the latency
+    for (int pending = align ? 0 : latencyFrames; pending > 0;) {
+        int frames = pending < FRAME_SIZE ? pending : FRAME_SIZE;
+        memset(noisySignal, 0, (size_t)frames * sfinfo.channels * sizeof(float));
+        memset(noiseSignal, 0, (size_t)frames * sfinfo.channels * sizeof(float));
+        anc_engine_process(engine, noiseSignal, noisySignal, filteredSignal, frames * sfinfo.channels);
+        write_trimmed(outputFile, filteredSignal, sfinfo.channels, frames, &skip);
+        pending -= frames;
+    }
+
+    // Clean up
+    sf_close(inputFile);
+    sf_close(noiseFile);
+    sf_close(outputFile);
+    anc_engine_destroy(engine);
+    free(noisySignal);
+    free(noiseSignal);
+    free(filteredSignal);
+    fft_plan_cache_free();
+
+    if (status != 0) return -1;
+    printf("Cleaned audio saved as 'cleaned_audio.wav'.\n");
+    return 0;
+}
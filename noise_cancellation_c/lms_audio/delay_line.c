@@ -0,0 +1,21 @@
+#include "delay_line.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int delay_line_init(DelayLine *dl, int length) {
+    dl->length = length;
+    dl->pos = 0;
+    dl->data = (double *)calloc(2 * (size_t)length, sizeof(double));
+    return dl->data ? 0 : -1;
+}
+
+void delay_line_reset(DelayLine *dl) {
+    dl->pos = 0;
+    memset(dl->data, 0, 2 * (size_t)dl->length * sizeof(double));
+}
+
+void delay_line_free(DelayLine *dl) {
+    free(dl->data);
+    dl->data = NULL;
+}
@@ -0,0 +1,40 @@
+// Mirrored ring buffer for tapped delay lines.
+//
+// Every sample is stored twice, `length` entries apart, so the newest
+// `length` samples are always one contiguous window (oldest first) that can
+// be passed straight to the SIMD kernels. A push is two stores and an index
+// increment instead of shifting the whole line.
+#ifndef DELAY_LINE_H
+#define DELAY_LINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int length;
+    int pos;        // Index of the oldest sample in the window
+    double *data;   // 2 * length entries
+} DelayLine;
+
+// Returns 0 on success, -1 if the buffer could not be allocated
+int delay_line_init(DelayLine *dl, int length);
+void delay_line_reset(DelayLine *dl);
+void delay_line_free(DelayLine *dl);
+
+static inline void delay_line_push(DelayLine *dl, double x) {
+    dl->data[dl->pos] = x;
+    dl->data[dl->pos + dl->length] = x;
+    if (++dl->pos == dl->length) dl->pos = 0;
+}
+
+// The last `length` samples, oldest first: window[length - 1] is the newest
+static inline const double *delay_line_window(const DelayLine *dl) {
+    return dl->data + dl->pos;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DELAY_LINE_H
@@ -0,0 +1,178 @@
+#include "delay_tracker.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define DELAY_MIN_TAIL 1024   // Decimated samples needed to analyse a short file
+
+int delay_tracker_init(DelayTracker *t, int sampleRate, int channels, float maxDelay) {
+    memset(t, 0, sizeof(*t));
+    if (sampleRate <= 0 || channels <= 0 || maxDelay <= 0.0f) return -1;
+    t->channels = channels;
+    t->maxLag = (int)ceilf(maxDelay * sampleRate / DELAY_DECIMATION);
+
+    // The window has to hold the largest lag several times over to give a
+    // clear peak; zero padding to twice its length avoids circular wrap
+    t->window = DELAY_MIN_WINDOW;
+    while (t->window < 4 * t->maxLag) t->window *= 2;
+    t->hop = t->window / 2;
+    t->plan = fft_plan_get(2 * t->window);
+    if (!t->plan) return -1;
+
+    int n = 2 * t->window;
+    t->primary = (float *)malloc(t->window * sizeof(float));
+    t->reference = (float *)malloc(t->window * sizeof(float));
+    t->spectrum = (float *)malloc((n + 2) * sizeof(float));
+    t->work = (float *)malloc((n + 2) * sizeof(float));
+    t->corr = (float *)malloc(n * sizeof(float));
+    if (!t->primary || !t->reference || !t->spectrum || !t->work || !t->corr) {
+        delay_tracker_free(t);
+        return -1;
+    }
+    return 0;
+}
+
+void delay_tracker_free(DelayTracker *t) {
+    free(t->primary);
+    free(t->reference);
+    free(t->spectrum);
+    free(t->work);
+    free(t->corr);
+    free(t->estimates);
+    t->primary = t->reference = t->spectrum = t->work = t->corr = NULL;
+    t->estimates = NULL;
+}
+
+static void add_estimate(DelayTracker *t, long long frame, float delay, float confidence) {
+    if (t->count == t->capacity) {
+        int capacity = t->capacity ? 2 * t->capacity : 64;
+        DelayEstimate *grown = (DelayEstimate *)realloc(t->estimates, capacity * sizeof(DelayEstimate));
+        if (!grown) return; // Keep tracking with the estimates we have
+        t->estimates = grown;
+        t->capacity = capacity;
+    }
+    DelayEstimate *e = &t->estimates[t->count++];
+    e->frame = frame;
+    e->delay = delay;
+    e->confidence = confidence;
+}
+
+// GCC-PHAT over the first `length` samples of the window
+static void analyse(DelayTracker *t, int length) {
+    int n = 2 * t->window, bins = t->window + 1;
+    float *P = t->spectrum, *R = t->work;
+
+    memcpy(t->corr, t->primary, length * sizeof(float));
+    memset(t->corr + length, 0, (n - length) * sizeof(float));
+    fft_real_forward(t->plan, t->corr, P);
+    memcpy(t->corr, t->reference, length * sizeof(float));
+    memset(t->corr + length, 0, (n - length) * sizeof(float));
+    fft_real_forward(t->plan, t->corr, R);
+
+    // Whitened cross spectrum P * conj(R) / |P * conj(R)|; DC and Nyquist
+    // carry no delay information
+    for (int k = 0; k < bins; k++) {
+        float re = P[2 * k] * R[2 * k] + P[2 * k + 1] * R[2 * k + 1];
+        float im = P[2 * k + 1] * R[2 * k] - P[2 * k] * R[2 * k + 1];
+        float mag = sqrtf(re * re + im * im);
+        float scale = k == 0 || k == bins - 1 || mag < 1e-20f ? 0.0f : 1.0f / mag;
+        P[2 * k] = re * scale;
+        P[2 * k + 1] = im * scale;
+    }
+    fft_real_inverse(t->plan, P, t->corr);
+
+    // corr[k] = sum p[i + k] r[i]: a peak at lag k means the primary lags by k
+    int maxLag = t->maxLag < length / 2 ? t->maxLag : length / 2;
+    int best = 0;
+    double energy = 0.0;
+    for (int lag = -maxLag; lag <= maxLag; lag++) {
+        float v = t->corr[(lag + n) % n];
+        energy += (double)v * v;
+        if (v > t->corr[(best + n) % n]) best = lag;
+    }
+    float peak = t->corr[(best + n) % n];
+    float rms = (float)sqrt(energy / (2 * maxLag + 1));
+    t->windows++;
+    if (rms <= 0.0f || peak / rms < DELAY_MIN_CONFIDENCE) return;
+
+    float left = t->corr[(best - 1 + n) % n], right = t->corr[(best + 1 + n) % n];
+    float curve = left - 2.0f * peak + right;
+    float offset = curve < 0.0f ? 0.5f * (left - right) / curve : 0.0f;
+    long long centre = t->windowStart + (long long)length * DELAY_DECIMATION / 2;
+    add_estimate(t, centre, (best + offset) * DELAY_DECIMATION, peak / rms);
+}
+
+void delay_tracker_push(DelayTracker *t, const float *primary, const float *reference, int frames) {
+    int channels = t->channels;
+    float norm = 1.0f / (channels * DELAY_DECIMATION);
+    for (int f = 0; f < frames; f++) {
+        // Mono mix and a boxcar over each group of DELAY_DECIMATION frames;
+        // the whitening makes up for the boxcar's droop
+        for (int c = 0; c < channels; c++) {
+            t->sumP += primary[(size_t)f * channels + c];
+            t->sumR += reference[(size_t)f * channels + c];
+        }
+        if (++t->phase < DELAY_DECIMATION) continue;
+
+        t->primary[t->fill] = t->sumP * norm;
+        t->reference[t->fill] = t->sumR * norm;
+        t->sumP = t->sumR = 0.0f;
+        t->phase = 0;
+
+        if (++t->fill == t->window) {
+            analyse(t, t->window);
+            memmove(t->primary, t->primary + t->hop, (t->window - t->hop) * sizeof(float));
+            memmove(t->reference, t->reference + t->hop, (t->window - t->hop) * sizeof(float));
+            t->fill -= t->hop;
+            t->windowStart += (long long)t->hop * DELAY_DECIMATION;
+        }
+    }
+}
+
+static float median3(float a, float b, float c) {
+    if (a > b) {
+        float s = a;
+        a = b;
+        b = s;
+    }
+    return c < a ? a : c > b ? b : c;
+}
+
+void delay_tracker_finish(DelayTracker *t) {
+    // Samples past the last full window. A file shorter than one window is
+    // analysed as a whole; otherwise the tail needs half a hop of new data.
+    if (t->windows == 0 ? t->fill >= DELAY_MIN_TAIL : t->fill - (t->window - t->hop) >= t->hop / 2) {
+        analyse(t, t->fill);
+    }
+
+    // A single stray window cannot move the track
+    if (t->count >= 3) {
+        float prev = t->estimates[0].delay;
+        for (int i = 1; i + 1 < t->count; i++) {
+            float current = t->estimates[i].delay;
+            t->estimates[i].delay = median3(prev, current, t->estimates[i + 1].delay);
+            prev = current;
+        }
+    }
+}
+
+float delay_tracker_delay_at(const DelayTracker *t, long long frame) {
+    if (t->count == 0) return 0.0f;
+    if (frame <= t->estimates[0].frame) return t->estimates[0].delay;
+    if (frame >= t->estimates[t->count - 1].frame) return t->estimates[t->count - 1].delay;
+
+    // Last estimate at or before frame
+    int lo = 0, hi = t->count - 1;
+    while (hi - lo > 1) {
+        int mid = (lo + hi) / 2;
+        if (t->estimates[mid].frame <= frame) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    const DelayEstimate *a = &t->estimates[lo], *b = &t->estimates[hi];
+    double w = (double)(frame - a->frame) / (double)(b->frame - a->frame);
+    return (float)(a->delay + w * (b->delay - a->delay));
+}
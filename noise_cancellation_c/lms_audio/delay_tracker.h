@@ -0,0 +1,66 @@
+// Bulk delay between a primary and a reference signal, tracked over time.
+//
+// Both signals are mixed to mono, decimated by DELAY_DECIMATION and cut
+// into half-overlapping windows. Each window's delay comes from the peak of
+// the GCC-PHAT cross-correlation (the cross spectrum whitened to unit
+// magnitude, so the peak stays sharp for coloured noise and reverberant
+// paths), refined to a fraction of a decimated sample by a parabola through
+// the peak. Windows whose peak does not stand out from the rest of the
+// correlation are dropped, the rest are median-filtered, and the delay
+// between window centres is interpolated linearly so slow clock drift is
+// followed across a long file.
+#ifndef DELAY_TRACKER_H
+#define DELAY_TRACKER_H
+
+#include "fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DELAY_DECIMATION 4
+#define DELAY_MIN_WINDOW 16384      // Decimated samples per window, at least
+#define DELAY_MIN_CONFIDENCE 8.0f   // Peak over RMS of the searched correlation
+
+typedef struct {
+    long long frame;     // Centre of the window, in input frames
+    float delay;         // Frames the primary lags the reference (negative if it leads)
+    float confidence;
+} DelayEstimate;
+
+typedef struct {
+    int channels;
+    int window, hop, maxLag;       // Decimated samples
+    const FFTPlan *plan;
+    float *primary, *reference;    // Current window, decimated
+    float *spectrum, *work, *corr;
+    int fill;
+    float sumP, sumR;              // Decimation accumulators
+    int phase;
+    long long windowStart;         // Input frame of primary[0]
+    int windows;                   // Windows analysed, accepted or not
+
+    DelayEstimate *estimates;      // Accepted windows, in order
+    int count, capacity;
+} DelayTracker;
+
+// maxDelay bounds |delay| in seconds. Returns 0 on success, -1 on failure.
+// Fetches an FFT plan, so call it before starting worker threads.
+int delay_tracker_init(DelayTracker *t, int sampleRate, int channels, float maxDelay);
+void delay_tracker_free(DelayTracker *t);
+
+// Feed `frames` interleaved frames of both signals
+void delay_tracker_push(DelayTracker *t, const float *primary, const float *reference, int frames);
+
+// Analyse the last partial window and smooth the estimates; call once after
+// the last push
+void delay_tracker_finish(DelayTracker *t);
+
+// Delay at an input frame, 0 if no window was accepted
+float delay_tracker_delay_at(const DelayTracker *t, long long frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DELAY_TRACKER_H
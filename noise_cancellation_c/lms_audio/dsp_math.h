@@ -0,0 +1,27 @@
+// Math shared by the filter and window designs: pi, which ISO C's math.h
+// does not define, and the Bessel function of Kaiser windows.
+#ifndef DSP_MATH_H
+#define DSP_MATH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSP_PI 3.14159265358979323846
+
+// Zeroth-order modified Bessel function of the first kind
+static inline double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 64 && term > 1e-12 * sum; k++) {
+        double q = x / (2.0 * k);
+        term *= q * q;
+        sum += term;
+    }
+    return sum;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DSP_MATH_H
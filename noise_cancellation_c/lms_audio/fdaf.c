@@ -0,0 +1,112 @@
+#include "fdaf.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int fdaf_init(FDAFilter *f, int taps, float mu, int constrained) {
+    memset(f, 0, sizeof(*f));
+    f->taps = taps;
+    f->mu = mu;
+    f->constrained = constrained;
+    f->plan = fft_plan_get(2 * taps);
+    if (!f->plan) return -1;
+
+    int bins = 2 * (taps + 1);
+    f->weights = (float *)calloc(bins, sizeof(float));
+    f->xTime = (float *)calloc(2 * taps, sizeof(float));
+    f->xFreq = (float *)calloc(bins, sizeof(float));
+    f->work = (float *)calloc(bins, sizeof(float));
+    f->timeBuf = (float *)calloc(2 * taps, sizeof(float));
+    f->inX = (float *)calloc(taps, sizeof(float));
+    f->inD = (float *)calloc(taps, sizeof(float));
+    f->outE = (float *)calloc(taps, sizeof(float));
+
+    if (!f->weights || !f->xTime || !f->xFreq || !f->work || !f->timeBuf || !f->inX || !f->inD || !f->outE) {
+        fdaf_free(f);
+        return -1;
+    }
+    return 0;
+}
+
+void fdaf_reset(FDAFilter *f) {
+    int taps = f->taps;
+    memset(f->weights, 0, 2 * (taps + 1) * sizeof(float));
+    memset(f->xTime, 0, 2 * taps * sizeof(float));
+    memset(f->outE, 0, taps * sizeof(float));
+    f->fill = 0;
+}
+
+void fdaf_free(FDAFilter *f) {
+    free(f->weights);
+    free(f->xTime);
+    free(f->xFreq);
+    free(f->work);
+    free(f->timeBuf);
+    free(f->inX);
+    free(f->inD);
+    free(f->outE);
+    f->weights = f->xTime = f->xFreq = f->work = f->timeBuf = NULL;
+    f->inX = f->inD = f->outE = NULL;
+}
+
+static void process_block(FDAFilter *f) {
+    int taps = f->taps;
+    int bins = taps + 1;
+    float *W = f->weights, *X = f->xFreq, *S = f->work, *t = f->timeBuf;
+
+    // Overlap-save input: previous block followed by the new one
+    memcpy(f->xTime + taps, f->inX, taps * sizeof(float));
+    fft_real_forward(f->plan, f->xTime, X);
+
+    // Filter output: the last `taps` samples of IFFT(X * W) are alias-free
+    for (int k = 0; k < bins; k++) {
+        float xr = X[2 * k], xi = X[2 * k + 1];
+        float wr = W[2 * k], wi = W[2 * k + 1];
+        S[2 * k] = xr * wr - xi * wi;
+        S[2 * k + 1] = xr * wi + xi * wr;
+    }
+    fft_real_inverse(f->plan, S, t);
+
+    for (int n = 0; n < taps; n++) {
+        f->outE[n] = f->inD[n] - t[taps + n]; // Error signal (clean audio)
+    }
+
+    // Gradient: correlate the error with the input, conj(X) * FFT([0, e])
+    memset(t, 0, taps * sizeof(float));
+    memcpy(t + taps, f->outE, taps * sizeof(float));
+    fft_real_forward(f->plan, t, S);
+
+    for (int k = 0; k < bins; k++) {
+        float xr = X[2 * k], xi = -X[2 * k + 1];
+        float er = S[2 * k], ei = S[2 * k + 1];
+        S[2 * k] = xr * er - xi * ei;
+        S[2 * k + 1] = xr * ei + xi * er;
+    }
+
+    if (f->constrained) {
+        // Keep only the causal half so the weights stay a `taps`-long filter
+        fft_real_inverse(f->plan, S, t);
+        memset(t + taps, 0, taps * sizeof(float));
+        fft_real_forward(f->plan, t, S);
+    }
+
+    // Update filter weights
+    for (int k = 0; k < 2 * bins; k++) {
+        W[k] += f->mu * S[k];
+    }
+
+    memcpy(f->xTime, f->xTime + taps, taps * sizeof(float));
+}
+
+void fdaf_process(FDAFilter *f, const float *x, const float *d, float *e, int count) {
+    for (int n = 0; n < count; n++) {
+        e[n] = f->outE[f->fill];
+        f->inX[f->fill] = x[n];
+        f->inD[f->fill] = d[n];
+
+        if (++f->fill == f->taps) {
+            process_block(f);
+            f->fill = 0;
+        }
+    }
+}
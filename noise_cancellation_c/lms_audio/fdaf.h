@@ -0,0 +1,49 @@
+// Frequency-domain adaptive filter (overlap-save block LMS).
+//
+// Filters and adapts `taps` weights one block of `taps` samples at a time
+// with FFTs of length 2 * taps, so the cost per sample grows with
+// log(taps) instead of taps. The constrained form applies the gradient
+// constraint and matches time-domain block LMS with the same step size. The
+// unconstrained form skips two of the five FFTs per block and converges to
+// a slightly different solution.
+//
+// Output is delayed by `taps` samples: e[n] belongs to input n - taps.
+#ifndef FDAF_H
+#define FDAF_H
+
+#include "fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int taps;          // Filter length and block length (a power of two)
+    int constrained;
+    float mu;
+    const FFTPlan *plan;
+
+    float *weights;    // taps + 1 complex bins of the zero-padded weights
+    float *xTime;      // Previous block followed by the current block (2 * taps)
+    float *xFreq;      // Spectrum of xTime
+    float *work;       // Scratch spectrum
+    float *timeBuf;    // Scratch time signal (2 * taps)
+
+    float *inX, *inD;  // Block being collected
+    float *outE;       // Errors of the last completed block
+    int fill;
+} FDAFilter;
+
+// Returns 0 on success, -1 for a bad size or allocation failure
+int fdaf_init(FDAFilter *f, int taps, float mu, int constrained);
+void fdaf_reset(FDAFilter *f);
+void fdaf_free(FDAFilter *f);
+
+// Same contract as lms_stream_process(), apart from the `taps`-sample delay
+void fdaf_process(FDAFilter *f, const float *x, const float *d, float *e, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FDAF_H
@@ -0,0 +1,186 @@
+#include "fft.h"
+#include "dsp_math.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FFT_MAX_LOG2 24
+
+static FFTPlan *planCache[FFT_MAX_LOG2 + 1];
+
+static FFTPlan *plan_create(int n) {
+    FFTPlan *plan = (FFTPlan *)calloc(1, sizeof(FFTPlan));
+    if (!plan) return NULL;
+
+    int half = n / 2;
+    plan->n = n;
+    plan->half = half;
+    plan->bitrev = (int *)malloc(half * sizeof(int));
+    plan->twiddle = (float *)malloc((half / 2 + 1) * 2 * sizeof(float));
+    plan->post = (float *)malloc(half * 2 * sizeof(float));
+
+    if (!plan->bitrev || !plan->twiddle || !plan->post) {
+        free(plan->bitrev);
+        free(plan->twiddle);
+        free(plan->post);
+        free(plan);
+        return NULL;
+    }
+
+    int bits = 0;
+    while ((1 << bits) < half) bits++;
+    for (int i = 0; i < half; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        plan->bitrev[i] = r;
+    }
+
+    // Tables are computed in double so large sizes keep full float accuracy
+    for (int k = 0; k <= half / 2; k++) {
+        double a = -2.0 * DSP_PI * k / half;
+        plan->twiddle[2 * k] = (float)cos(a);
+        plan->twiddle[2 * k + 1] = (float)sin(a);
+    }
+    for (int k = 0; k < half; k++) {
+        double a = -2.0 * DSP_PI * k / n;
+        plan->post[2 * k] = (float)cos(a);
+        plan->post[2 * k + 1] = (float)sin(a);
+    }
+    return plan;
+}
+
+const FFTPlan *fft_plan_get(int n) {
+    int log2n = 0;
+    while ((1 << log2n) < n) log2n++;
+    if (n < 4 || (1 << log2n) != n || log2n > FFT_MAX_LOG2) return NULL;
+
+    if (!planCache[log2n]) planCache[log2n] = plan_create(n);
+    return planCache[log2n];
+}
+
+void fft_plan_cache_free(void) {
+    for (int i = 0; i <= FFT_MAX_LOG2; i++) {
+        if (!planCache[i]) continue;
+        free(planCache[i]->bitrev);
+        free(planCache[i]->twiddle);
+        free(planCache[i]->post);
+        free(planCache[i]);
+        planCache[i] = NULL;
+    }
+}
+
+// In-place radix-2 complex FFT of plan->half points; sign = -1 forward, +1 inverse
+static void fft_complex(const FFTPlan *plan, float *data, int sign) {
+    int m = plan->half;
+
+    for (int i = 0; i < m; i++) {
+        int j = plan->bitrev[i];
+        if (j > i) {
+            float re = data[2 * i], im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+
+    for (int len = 2; len <= m; len <<= 1) {
+        int step = m / len;
+        int halfLen = len / 2;
+        for (int start = 0; start < m; start += len) {
+            float *a = data + 2 * start;
+            float *b = a + 2 * halfLen;
+            for (int j = 0; j < halfLen; j++) {
+                float wr = plan->twiddle[2 * j * step];
+                float wi = sign < 0 ? plan->twiddle[2 * j * step + 1] : -plan->twiddle[2 * j * step + 1];
+                float tr = b[2 * j] * wr - b[2 * j + 1] * wi;
+                float ti = b[2 * j] * wi + b[2 * j + 1] * wr;
+                b[2 * j] = a[2 * j] - tr;
+                b[2 * j + 1] = a[2 * j + 1] - ti;
+                a[2 * j] += tr;
+                a[2 * j + 1] += ti;
+            }
+        }
+    }
+}
+
+void fft_real_forward(const FFTPlan *plan, const float *in, float *out) {
+    int m = plan->half;
+
+    // Pack even/odd samples as one complex sequence of half the length
+    if (out != in) memcpy(out, in, plan->n * sizeof(float));
+    fft_complex(plan, out, -1);
+
+    // Split the packed spectrum into the spectrum of the real input
+    float z0r = out[0], z0i = out[1];
+    out[0] = z0r + z0i;
+    out[1] = 0.0f;
+    out[2 * m] = z0r - z0i;
+    out[2 * m + 1] = 0.0f;
+
+    for (int k = 1; k <= m / 2; k++) {
+        int j = m - k;
+        float ar = out[2 * k], ai = out[2 * k + 1];
+        float br = out[2 * j], bi = out[2 * j + 1];
+
+        // X[k] = (A + conj(B))/2 - i W^k (A - conj(B))/2, with A = Z[k], B = Z[m-k]
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+        float orr = 0.5f * (ar - br), oi = 0.5f * (ai + bi);
+        float wr = plan->post[2 * k], wi = plan->post[2 * k + 1];
+        float tr = wr * orr - wi * oi, ti = wr * oi + wi * orr;
+        out[2 * k] = er + ti;
+        out[2 * k + 1] = ei - tr;
+
+        if (j != k) {
+            // Same formula for index m-k, where A and B swap roles
+            float er2 = er, ei2 = -ei;
+            float or2 = -orr, oi2 = oi;
+            float wr2 = plan->post[2 * j], wi2 = plan->post[2 * j + 1];
+            float tr2 = wr2 * or2 - wi2 * oi2, ti2 = wr2 * oi2 + wi2 * or2;
+            out[2 * j] = er2 + ti2;
+            out[2 * j + 1] = ei2 - tr2;
+        }
+    }
+}
+
+void fft_real_inverse(const FFTPlan *plan, float *in, float *out) {
+    int m = plan->half;
+
+    // Rebuild the packed spectrum Z[k] = Xe[k] + i Xo[k]
+    float x0 = in[0], xm = in[2 * m];
+    in[0] = 0.5f * (x0 + xm);
+    in[1] = 0.5f * (x0 - xm);
+
+    for (int k = 1; k <= m / 2; k++) {
+        int j = m - k;
+        float ar = in[2 * k], ai = in[2 * k + 1];
+        float br = in[2 * j], bi = in[2 * j + 1];
+
+        // Xe = (X[k] + conj X[m-k])/2, Xo = (X[k] - conj X[m-k]) conj(W^k)/2
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+        float dr = 0.5f * (ar - br), di = 0.5f * (ai + bi);
+        float wr = plan->post[2 * k], wi = -plan->post[2 * k + 1];
+        float orr = dr * wr - di * wi, oi = dr * wi + di * wr;
+        in[2 * k] = er - oi;
+        in[2 * k + 1] = ei + orr;
+
+        if (j != k) {
+            float er2 = er, ei2 = -ei;
+            float dr2 = -dr, di2 = di;
+            float wr2 = plan->post[2 * j], wi2 = -plan->post[2 * j + 1];
+            float or2 = dr2 * wr2 - di2 * wi2, oi2 = dr2 * wi2 + di2 * wr2;
+            in[2 * j] = er2 - oi2;
+            in[2 * j + 1] = ei2 + or2;
+        }
+    }
+
+    fft_complex(plan, in, 1);
+
+    float scale = 1.0f / m;
+    for (int i = 0; i < plan->n; i++) {
+        out[i] = in[i] * scale;
+    }
+}
@@ -0,0 +1,37 @@
+// Real-input FFT with cached plans.
+//
+// A plan holds the bit-reversal and twiddle tables for one power-of-two
+// size. fft_plan_get() builds each size once and returns the same plan on
+// later calls; plans live until fft_plan_cache_free().
+#ifndef FFT_H
+#define FFT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int n;             // Real transform length
+    int half;          // n / 2, length of the inner complex FFT
+    int *bitrev;       // half entries
+    float *twiddle;    // half/2 complex factors exp(-2*pi*i*k/half)
+    float *post;       // half complex factors exp(-2*pi*i*k/n) for the real split
+} FFTPlan;
+
+// Returns the cached plan for n (a power of two, at least 4), or NULL.
+// Not thread-safe: fetch plans before starting worker threads.
+const FFTPlan *fft_plan_get(int n);
+void fft_plan_cache_free(void);
+
+// n real samples -> n/2 + 1 complex bins, interleaved (n + 2 floats)
+void fft_real_forward(const FFTPlan *plan, const float *in, float *out);
+
+// n/2 + 1 complex bins -> n real samples, scaled by 1/n. `in` is used as
+// scratch and does not keep its contents.
+void fft_real_inverse(const FFTPlan *plan, float *in, float *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FFT_H
@@ -1,89 +1,127 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-// WAV file header structure (44 bytes)
-typedef struct {
-    char chunkID[4];      // "RIFF"
-    int chunkSize;
-    char format[4];       // "WAVE"
-    char subchunk1ID[4];  // "fmt "
-    int subchunk1Size;
-    short audioFormat;
-    short numChannels;
-    int sampleRate;
-    int byteRate;
-    short blockAlign;
-    short bitsPerSample;
-    char subchunk2ID[4];  // "data"
-    int subchunk2Size;
-} WAVHeader;
-
-void convert_to_mono_16bit_44kHz(const char *inputFile, const char *outputFile) {
-    FILE *inFile = fopen(inputFile, "rb");
-    if (!inFile) {
-        printf("Error: Cannot open input file %s\n", inputFile);
-        return;
-    }
-
-    // Read the WAV header
-    WAVHeader header;
-    fread(&header, sizeof(WAVHeader), 1, inFile);
-
-    // Print original file info
-    printf("Original WAV File: %d Hz, %d-bit, %d channel(s)\n",
-           header.sampleRate, header.bitsPerSample, header.numChannels);
-
-    // Ensure the input is PCM format
-    if (header.audioFormat != 1) {
-        printf("Error: Only PCM WAV files are supported!\n");
-        fclose(inFile);
-        return;
-    }
-
-    // Convert to 16-bit, mono, 44.1kHz
-    header.sampleRate = 44100;
-    header.numChannels = 1;
-    header.bitsPerSample = 16;
-    header.byteRate = header.sampleRate * header.numChannels * (header.bitsPerSample / 8);
-    header.blockAlign = header.numChannels * (header.bitsPerSample / 8);
-    header.subchunk2Size = header.subchunk2Size / header.numChannels; // Adjust for mono
-    header.chunkSize = 36 + header.subchunk2Size; // Update chunk size
-
-    FILE *outFile = fopen(outputFile, "wb");
-    if (!outFile) {
-        printf("Error: Cannot create output file %s\n", outputFile);
-        fclose(inFile);
-        return;
-    }
-
-    // Write updated header to output file
-    fwrite(&header, sizeof(WAVHeader), 1, outFile);
-
-    // Process audio data
-    short sample;
-    int totalSamples = header.subchunk2Size / (header.bitsPerSample / 8);
-    for (int i = 0; i < totalSamples; i++) {
-        fread(&sample, sizeof(short), 1, inFile);
-        fwrite(&sample, sizeof(short), 1, outFile);
-        
-        // Skip extra channel in stereo input
-        if (header.numChannels == 2) {
-            fseek(inFile, sizeof(short), SEEK_CUR);
-        }
-    }
-
-    fclose(inFile);
-    fclose(outFile);
-
-    printf("Conversion complete! Output saved as '%s'.\n", outputFile);
-}
-
-int main() {
-    const char *inputWAV = "noisy_audio.wav";
-    const char *outputWAV = "converted_audio.wav";
-
-    convert_to_mono_16bit_44kHz(inputWAV, outputWAV);
-
-    return 0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pcm_convert.h"
+#include "resampler.h"
+#include "simd_kernels.h"
+#include "wav_io.h"
+
+#define TARGET_RATE 44100
+#define BLOCK_FRAMES 4096   // Input frames resampled per step
+
+void convert_to_mono_16bit(const char *inputFile, const char *outputFile, int targetRate) {
+    WAVFile in;
+    if (wav_open(inputFile, &in) != 0) {
+        printf("Error: Cannot open input file %s\n", inputFile);
+        return;
+    }
+
+    // Print original file info
+    printf("Original WAV File: %d Hz, %d-bit, %d channel(s)\n",
+           in.fmt.sampleRate, in.fmt.bitsPerSample, in.fmt.numChannels);
+
+    // 8/16/24/32-bit PCM and 32/64-bit float are all accepted
+    PCMEncoding encoding = pcm_encoding(&in.fmt);
+    if (encoding == PCM_UNSUPPORTED) {
+        printf("Error: Unsupported sample format (format %d, %d-bit)\n", in.fmt.audioFormat, in.fmt.bitsPerSample);
+        wav_close(&in);
+        return;
+    }
+
+    // Convert to 16-bit, mono, targetRate
+    WAVFormat fmt = in.fmt;
+    fmt.audioFormat = WAV_FORMAT_PCM;
+    fmt.sampleRate = targetRate;
+    fmt.numChannels = 1;
+    fmt.bitsPerSample = 16;
+    fmt.byteRate = fmt.sampleRate * fmt.numChannels * (fmt.bitsPerSample / 8);
+    fmt.blockAlign = fmt.numChannels * (fmt.bitsPerSample / 8);
+
+    Resampler rs;
+    if (resampler_init(&rs, in.fmt.sampleRate, targetRate, BLOCK_FRAMES) != 0) {
+        printf("Error: Cannot resample %d Hz to %d Hz\n", in.fmt.sampleRate, targetRate);
+        wav_close(&in);
+        return;
+    }
+    int passthrough = in.fmt.sampleRate == targetRate;
+
+    int outCapacity = resampler_max_output(&rs, BLOCK_FRAMES);
+    float *block = (float *)malloc(BLOCK_FRAMES * sizeof(float));
+    float *resampled = (float *)malloc(outCapacity * sizeof(float));
+    short *pcm = (short *)malloc(outCapacity * sizeof(short));
+    FILE *out = fopen(outputFile, "wb");
+    if (!block || !resampled || !pcm || !out) {
+        printf(out ? "Error: Out of memory\n" : "Error: Cannot create output file %s\n", outputFile);
+        if (out) fclose(out);
+        free(block);
+        free(resampled);
+        free(pcm);
+        resampler_free(&rs);
+        wav_close(&in);
+        return;
+    }
+
+    // The output length is known up front: ceil(frames * targetRate / inputRate)
+    size_t outFrames = (size_t)(((unsigned long long)in.numFrames * rs.up + rs.down - 1) / rs.down);
+    int status = wav_write_header(out, &fmt, outFrames * sizeof(short));
+
+    // Downmix every frame to mono, resampled a block at a time
+    const unsigned char *data = (const unsigned char *)in.data;
+    size_t written = 0;
+    for (size_t start = 0; status == 0 && start < in.numFrames; start += BLOCK_FRAMES) {
+        int count = in.numFrames - start < BLOCK_FRAMES ? (int)(in.numFrames - start) : BLOCK_FRAMES;
+        pcm_to_mono(data + start * in.fmt.blockAlign, encoding, in.fmt.numChannels, count, block);
+        int produced = count;
+        if (passthrough) {
+            simd_f32_to_i16(block, pcm, 32768.0f, count);
+        } else {
+            produced = resampler_process(&rs, block, count, resampled);
+            simd_f32_to_i16(resampled, pcm, 32768.0f, produced);
+        }
+        if (fwrite(pcm, sizeof(short), produced, out) != (size_t)produced) status = -1;
+        written += produced;
+    }
+    if (status == 0 && !passthrough) {
+        int produced = resampler_flush(&rs, resampled);
+        simd_f32_to_i16(resampled, pcm, 32768.0f, produced);
+        if (fwrite(pcm, sizeof(short), produced, out) != (size_t)produced) status = -1;
+        written += produced;
+    }
+    if (fclose(out) != 0 || written != outFrames) status = -1;
+
+    free(block);
+    free(resampled);
+    free(pcm);
+    resampler_free(&rs);
+    wav_close(&in);
+
+    if (status == 0) {
+        printf("Conversion complete! Output saved as '%s'.\n", outputFile);
+    } else {
+        printf("Error writing %s\n", outputFile);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *inputWAV = "noisy_audio.wav";
+    const char *outputWAV = "converted_audio.wav";
+    int targetRate = TARGET_RATE;
+
+    int arg = 1;
+    if (arg + 1 < argc && strcmp(argv[arg], "--rate") == 0) {
+        targetRate = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if ((argc - arg != 0 && argc - arg != 2) || targetRate <= 0) {
+        printf("Usage: %s [--rate HZ] [input.wav output.wav]\n", argv[0]);
+        return 1;
+    }
+    if (argc - arg == 2) {
+        inputWAV = argv[arg];
+        outputWAV = argv[arg + 1];
+    }
+
+    convert_to_mono_16bit(inputWAV, outputWAV, targetRate);
+
+    return 0;
+}
@@ -1,111 +1,114 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-#define N 128   // Number of filter coefficients
-#define MU 0.01 // Step size
-
-// WAV file header (44 bytes)
-typedef struct {
-    char chunkID[4];
-    int chunkSize;
-    char format[4];
-    char subchunk1ID[4];
-    int subchunk1Size;
-    short audioFormat;
-    short numChannels;
-    int sampleRate;
-    int byteRate;
-    short blockAlign;
-    short bitsPerSample;
-    char subchunk2ID[4];
-    int subchunk2Size;
-} WAVHeader;
-
-void adaptive_noise_cancellation(short *x, short *d, float *w, short *e, int length) {
-    float y;
-
-    for (int n = N - 1; n < length; n++) {
-        y = 0.0;
-
-        // Compute filter output (estimated noise)
-        for (int i = 0; i < N; i++) {
-            y += w[i] * x[n - i];
-        }
-
-        e[n] = d[n] - (short)y; // Error signal (clean audio)
-
-        // Update filter weights
-        for (int i = 0; i < N; i++) {
-            w[i] += MU * e[n] * x[n - i];
-        }
-    }
-}
-
-int main() {
-    FILE *noisyFile, *noiseFile, *outputFile;
-    WAVHeader header;
-
-    // Open noisy WAV file
-    noisyFile = fopen("D:\\Downloads\\noise_cancellation_c\\lms_audio\\converted_audio.wav", "rb");
-    noiseFile = fopen("noisy_audio.wav", "rb");
-
-    if (!noisyFile || !noiseFile) {
-        printf("Error opening input files!\n");
-        return -1;
-    }
-
-    // Read and verify WAV header
-    fread(&header, sizeof(WAVHeader), 1, noisyFile);
-    fseek(noiseFile, 44, SEEK_SET); // Skip header for noise file
-
-    // Ensure it's a valid WAV file
-    if (strncmp(header.chunkID, "RIFF", 4) || strncmp(header.format, "WAVE", 4)) {
-        printf("Invalid WAV file!\n");
-        return -1;
-    }
-
-    // Calculate number of samples
-    int length = header.subchunk2Size / (header.bitsPerSample / 8);
-
-    // Allocate memory
-    short *noisySignal = (short *)malloc(length * sizeof(short));
-    short *noiseSignal = (short *)malloc(length * sizeof(short));
-    short *filteredSignal = (short *)malloc(length * sizeof(short));
-    float w[N] = {0}; // Adaptive filter weights
-
-    // Read audio samples
-    fread(noisySignal, sizeof(short), length, noisyFile);
-    fread(noiseSignal, sizeof(short), length, noiseFile);
-
-    fclose(noisyFile);
-    fclose(noiseFile);
-
-    // Apply LMS noise cancellation
-    adaptive_noise_cancellation(noiseSignal, noisySignal, w, filteredSignal, length);
-
-    // Update subchunk2Size for output file
-    header.subchunk2Size = length * sizeof(short);
-    header.chunkSize = 36 + header.subchunk2Size; // Total size
-
-    // Write cleaned output as WAV
-    outputFile = fopen("cleaned_audio.wav", "wb");
-    fwrite(&header, sizeof(WAVHeader), 1, outputFile); // Write WAV header
-
-    // Ensure little-endian order for samples
-    for (int i = 0; i < length; i++) {
-        short sample = filteredSignal[i];
-        sample = (sample & 0xFF) << 8 | (sample >> 8); // Swap byte order
-        fwrite(&sample, sizeof(short), 1, outputFile);
-    }
-
-    fclose(outputFile);
-
-    // Cleanup
-    free(noisySignal);
-    free(noiseSignal);
-    free(filteredSignal);
-
-    printf("Noise removed! Output saved as 'cleaned_audio.wav'.\n");
-    return 0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lms_filter.hpp"
+#include "wav_io.h"
+
+#define N 128   // Default number of filter coefficients
+#define MU 0.01 // Default step size
+
+static void usage(const char *prog) {
+    printf("Usage: %s [--taps N] [--mu MU] [--double] [<noisy.wav> <noise.wav> <output.wav>]\n", prog);
+    printf("Tap counts from %d to %d run a compile-time specialized filter, rounded up\n", kMinSpecializedTaps, kMaxSpecializedTaps);
+    printf("to a power of two; other lengths use the runtime-sized filter.\n");
+}
+
+// Apply LMS noise cancellation with weights and sums in precision Real
+template <typename Real>
+static int adaptive_noise_cancellation(const short *x, const short *d, short *e, int length, int taps, double mu) {
+    std::unique_ptr<AdaptiveFilter<short, Real>> filter = make_lms_filter<short, Real>(taps, Real(mu));
+
+    if (filter->taps() != taps) {
+        printf("Using the %d-tap specialization for %d taps.\n", filter->taps(), taps);
+    }
+    filter->process(x, d, e, length);
+    return filter->taps();
+}
+
+int main(int argc, char *argv[]) {
+    const char *noisyPath = "converted_audio.wav";
+    const char *noisePath = "noisy_audio.wav";
+    const char *outputPath = "cleaned_audio.wav";
+    const char *paths[3];
+    int pathCount = 0;
+    int taps = N;
+    double mu = MU;
+    int useDouble = 0;
+    WAVFile noisyWav, noiseWav;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--taps") == 0 && i + 1 < argc) {
+            taps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--mu") == 0 && i + 1 < argc) {
+            mu = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--double") == 0) {
+            useDouble = 1;
+        } else if (argv[i][0] != '-' && pathCount < 3) {
+            paths[pathCount++] = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (pathCount == 3) {
+        noisyPath = paths[0];
+        noisePath = paths[1];
+        outputPath = paths[2];
+    } else if (pathCount != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (taps < 1 || mu <= 0.0) {
+        printf("Error: --taps must be positive and --mu greater than zero.\n");
+        return 1;
+    }
+
+    // Map and verify both WAV files (wav_open walks the RIFF chunks)
+    if (wav_open(noisyPath, &noisyWav) != 0) return -1;
+    if (wav_open(noisePath, &noiseWav) != 0) {
+        wav_close(&noisyWav);
+        return -1;
+    }
+
+    const short *noisySignal = wav_samples_i16(&noisyWav);
+    const short *noiseSignal = wav_samples_i16(&noiseWav);
+    if (!noisySignal || !noiseSignal) {
+        printf("Error: Only 16-bit PCM WAV files are supported!\n");
+        wav_close(&noisyWav);
+        wav_close(&noiseWav);
+        return -1;
+    }
+
+    // Calculate number of samples
+    int length = (int)(noisyWav.numSamples < noiseWav.numSamples ? noisyWav.numSamples : noiseWav.numSamples);
+
+    // Allocate memory
+    short *filteredSignal = (short *)calloc(length, sizeof(short));
+    if (!filteredSignal) {
+        printf("Error: Out of memory!\n");
+        wav_close(&noisyWav);
+        wav_close(&noiseWav);
+        return -1;
+    }
+
+    // Apply LMS noise cancellation
+    if (useDouble) {
+        adaptive_noise_cancellation<double>(noiseSignal, noisySignal, filteredSignal, length, taps, mu);
+    } else {
+        adaptive_noise_cancellation<float>(noiseSignal, noisySignal, filteredSignal, length, taps, mu);
+    }
+
+    // Write cleaned output as WAV
+    int status = wav_write_i16(outputPath, &noisyWav.fmt, filteredSignal, length);
+
+    // Cleanup
+    wav_close(&noisyWav);
+    wav_close(&noiseWav);
+    free(filteredSignal);
+    if (status != 0) return -1;
+
+    printf("Noise removed! Output saved as '%s'.\n", outputPath);
+    return 0;
+}
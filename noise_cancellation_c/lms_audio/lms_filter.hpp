@@ -0,0 +1,208 @@
+// Compile-time specialized LMS filter engine.
+//
+// LMSFilter<Taps, Sample, Real> fixes the tap count, the sample type seen by
+// callers (short PCM or float) and the precision of the weights and sums.
+// With Taps known at compile time every inner loop has a constant trip count,
+// so the compiler can unroll and vectorize it completely. Taps == 0 is the
+// runtime-sized fallback for lengths outside the specialized range.
+//
+// make_lms_filter() picks a specialization at run time: lengths between
+// kMinSpecializedTaps and kMaxSpecializedTaps round up to the next
+// instantiated power of two, everything else gets the runtime-sized filter.
+// The filter is never shorter than asked for: the extra taps start at zero
+// and only reach further back in time, so it still covers the whole path.
+#ifndef LMS_FILTER_HPP
+#define LMS_FILTER_HPP
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+constexpr int kLmsBlock = 256;            // Samples filtered per internal block
+constexpr int kLmsLanes = 8;              // Independent partial sums in the dot product
+constexpr int kMinSpecializedTaps = 16;
+constexpr int kMaxSpecializedTaps = 512;
+
+// Conversion between the caller's sample type and the filter precision.
+// 16-bit PCM maps to [-1, 1) so the step size means the same for every type.
+template <typename Sample>
+struct SampleTraits;
+
+template <>
+struct SampleTraits<short> {
+    template <typename Real>
+    static Real to_real(short v) {
+        return v * Real(1.0 / 32768.0);
+    }
+
+    template <typename Real>
+    static short from_real(Real v) {
+        v *= Real(32768.0);
+        if (v > Real(32767.0)) v = Real(32767.0);
+        if (v < Real(-32768.0)) v = Real(-32768.0);
+        return (short)std::lround(v);
+    }
+};
+
+template <>
+struct SampleTraits<float> {
+    template <typename Real>
+    static Real to_real(float v) {
+        return Real(v);
+    }
+
+    template <typename Real>
+    static float from_real(Real v) {
+        return float(v);
+    }
+};
+
+// Weights and delay line with the tap count baked in...
+template <int Taps, typename Real>
+struct FilterStorage {
+    explicit FilterStorage(int) {}
+    static constexpr int size() { return Taps; }
+
+    Real weights[Taps];
+    Real history[Taps - 1 + kLmsBlock];
+};
+
+// ...or chosen at run time
+template <typename Real>
+struct FilterStorage<0, Real> {
+    explicit FilterStorage(int taps) : taps_(taps), weightData_(taps), historyData_(taps - 1 + kLmsBlock) {
+        weights = weightData_.data();
+        history = historyData_.data();
+    }
+    int size() const { return taps_; }
+
+    // weights and history point into this object's own vectors
+    FilterStorage(const FilterStorage &) = delete;
+    FilterStorage &operator=(const FilterStorage &) = delete;
+
+    int taps_;
+    std::vector<Real> weightData_;
+    std::vector<Real> historyData_;
+    Real *weights;
+    Real *history;
+};
+
+// Runtime interface, so one pointer can hold any specialization
+template <typename Sample, typename Real>
+class AdaptiveFilter {
+public:
+    virtual ~AdaptiveFilter() {}
+    virtual void reset() = 0;
+    virtual int taps() const = 0;
+
+    // x is the noise reference, d the noisy input, e receives the error
+    // (cleaned) signal. State carries over between calls.
+    virtual void process(const Sample *x, const Sample *d, Sample *e, int count) = 0;
+};
+
+template <int Taps, typename Sample, typename Real>
+class LMSFilter : public AdaptiveFilter<Sample, Real> {
+public:
+    LMSFilter(int taps, Real mu) : store_(taps), mu_(mu) { reset(); }
+
+    void reset() override {
+        std::memset(store_.weights, 0, store_.size() * sizeof(Real));
+        std::memset(store_.history, 0, (store_.size() - 1 + kLmsBlock) * sizeof(Real));
+    }
+
+    int taps() const override { return store_.size(); }
+
+    void process(const Sample *x, const Sample *d, Sample *e, int count) override {
+        while (count > 0) {
+            int block = count < kLmsBlock ? count : kLmsBlock;
+            process_block(x, d, e, block);
+            x += block;
+            d += block;
+            e += block;
+            count -= block;
+        }
+    }
+
+private:
+    // Apply w += g * prev and return sum(w * win) in the same pass, with
+    // kLmsLanes partial sums so the loop vectorizes without reassociation.
+    // Weights and history never overlap; saying so lets -O2 vectorize too.
+    Real lms_step(const Real *__restrict prev, Real g, const Real *__restrict win) {
+        Real *__restrict w = store_.weights;
+        const int n = store_.size();
+        Real acc[kLmsLanes] = {};
+        int i = 0;
+        for (; i + kLmsLanes <= n; i += kLmsLanes) {
+            for (int j = 0; j < kLmsLanes; j++) {
+                w[i + j] += g * prev[i + j];
+                acc[j] += w[i + j] * win[i + j];
+            }
+        }
+        for (; i < n; i++) {
+            w[i] += g * prev[i];
+            acc[0] += w[i] * win[i];
+        }
+
+        Real y = 0;
+        for (int j = 0; j < kLmsLanes; j++) y += acc[j];
+        return y;
+    }
+
+    // Same layout as LMSStream: the window for sample n is hist[n .. n + taps - 1]
+    void process_block(const Sample *x, const Sample *d, Sample *e, int count) {
+        const int n = store_.size();
+        Real *hist = store_.history;
+
+        for (int i = 0; i < count; i++) hist[n - 1 + i] = SampleTraits<Sample>::template to_real<Real>(x[i]);
+
+        // The previous block already applied its last update, so sample 0
+        // starts with nothing pending
+        Real g = 0;
+        for (int i = 0; i < count; i++) {
+            Real y = lms_step(i > 0 ? hist + i - 1 : hist, g, hist + i);
+            Real err = SampleTraits<Sample>::template to_real<Real>(d[i]) - y;
+            e[i] = SampleTraits<Sample>::template from_real<Real>(err);
+            g = mu_ * err;
+        }
+
+        // Update filter weights for the last sample of the block
+        Real *__restrict w = store_.weights;
+        const Real *last = hist + count - 1;
+        for (int i = 0; i < n; i++) w[i] += g * last[i];
+
+        // Carry the newest taps - 1 samples over to the next block
+        std::memmove(hist, hist + count, (n - 1) * sizeof(Real));
+    }
+
+    FilterStorage<Taps, Real> store_;
+    Real mu_;
+};
+
+// Smallest specialized length that holds taps, for taps up to
+// kMaxSpecializedTaps
+inline int covering_specialization(int taps) {
+    int size = kMinSpecializedTaps;
+    while (size < taps) size *= 2;
+    return size;
+}
+
+template <typename Sample, typename Real>
+std::unique_ptr<AdaptiveFilter<Sample, Real>> make_lms_filter(int taps, Real mu) {
+    typedef std::unique_ptr<AdaptiveFilter<Sample, Real>> Ptr;
+
+    if (taps < kMinSpecializedTaps || taps > kMaxSpecializedTaps) {
+        return Ptr(new LMSFilter<0, Sample, Real>(taps, mu));
+    }
+
+    switch (covering_specialization(taps)) {
+    case 16: return Ptr(new LMSFilter<16, Sample, Real>(16, mu));
+    case 32: return Ptr(new LMSFilter<32, Sample, Real>(32, mu));
+    case 64: return Ptr(new LMSFilter<64, Sample, Real>(64, mu));
+    case 128: return Ptr(new LMSFilter<128, Sample, Real>(128, mu));
+    case 256: return Ptr(new LMSFilter<256, Sample, Real>(256, mu));
+    default: return Ptr(new LMSFilter<512, Sample, Real>(512, mu));
+    }
+}
+
+#endif // LMS_FILTER_HPP
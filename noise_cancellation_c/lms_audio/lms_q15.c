@@ -0,0 +1,81 @@
+#include "lms_q15.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "simd_kernels.h"
+
+static short saturate16(long long v) {
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (short)v;
+}
+
+int lms_q15_init(LMSQ15 *s, int taps, float mu, int maxBlock) {
+    long q = (long)(mu * 32768.0f + 0.5f);
+
+    s->taps = taps;
+    s->maxBlock = maxBlock;
+    s->mu = (short)(q < 1 ? 1 : q > 32767 ? 32767 : q);
+    s->g = 0;
+    s->weights = (short *)calloc(taps, sizeof(short));
+    s->history = (short *)calloc(taps + maxBlock, sizeof(short));
+
+    if (!s->weights || !s->history) {
+        lms_q15_free(s);
+        return -1;
+    }
+    return 0;
+}
+
+void lms_q15_reset(LMSQ15 *s) {
+    s->g = 0;
+    memset(s->weights, 0, s->taps * sizeof(short));
+    memset(s->history, 0, (s->taps + s->maxBlock) * sizeof(short));
+}
+
+void lms_q15_free(LMSQ15 *s) {
+    free(s->weights);
+    free(s->history);
+    s->weights = NULL;
+    s->history = NULL;
+}
+
+static void process_block(LMSQ15 *s, const short *x, const short *d, short *e, int count) {
+    int taps = s->taps;
+    short *hist = s->history;
+    short g = s->g;
+
+    // One extra carried sample compared to LMSStream: the window of the
+    // previous sample, hist[n .. n + taps - 1], is still there when sample n
+    // (window hist[n + 1 ..]) applies its update, so the pending update can
+    // simply be carried over a block boundary in `g`
+    memcpy(hist + taps, x, count * sizeof(short));
+
+    for (int n = 0; n < count; n++) {
+        // Apply the previous weight update and filter the current sample in one pass
+        long long acc = simd_lms_step_q15(s->weights, hist + n, g, hist + n + 1, taps);
+
+        // Q30 -> Q15 with rounding, then the saturated error (clean audio)
+        short y = saturate16((acc + 0x4000) >> 15);
+        e[n] = saturate16((long long)d[n] - y);
+
+        // mu < 1, so mu * e always fits and never reaches -32768
+        g = (short)(((int)s->mu * e[n] + 0x4000) >> 15);
+    }
+
+    s->g = g;
+
+    // Carry the newest taps samples over to the next block
+    memmove(hist, hist + count, taps * sizeof(short));
+}
+
+void lms_q15_process(LMSQ15 *s, const short *x, const short *d, short *e, int count) {
+    while (count > 0) {
+        int block = count < s->maxBlock ? count : s->maxBlock;
+        process_block(s, x, d, e, block);
+        x += block;
+        d += block;
+        e += block;
+        count -= block;
+    }
+}
@@ -0,0 +1,42 @@
+// Streaming Q15 fixed-point LMS filter.
+//
+// Samples, weights and the step size are all Q15 (16-bit, 1.0 = 32768) and
+// the sample path never touches floating point: the output sum is
+// accumulated exactly in 64 bits (Q30), rounded back to Q15 and every
+// addition saturates instead of wrapping. Results are bit-exact across the
+// scalar and SIMD kernel levels, so they can be compared sample for sample
+// against a fixed-point DSP implementation.
+//
+// Same streaming contract as LMSStream: only the weights and the last
+// `taps` reference samples are kept between calls.
+#ifndef LMS_Q15_H
+#define LMS_Q15_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int taps;
+    int maxBlock;
+    short mu;         // Step size in Q15
+    short g;          // Pending update gain mu * e for the last sample
+    short *weights;   // weights[taps - 1 - i] multiplies x[n - i] (oldest tap first)
+    short *history;   // taps carried samples followed by the current block
+} LMSQ15;
+
+// mu is converted to Q15 once here and must be in (0, 1). Returns 0 on
+// success, -1 if the state could not be allocated.
+int lms_q15_init(LMSQ15 *s, int taps, float mu, int maxBlock);
+void lms_q15_reset(LMSQ15 *s);
+void lms_q15_free(LMSQ15 *s);
+
+// Filter `count` 16-bit samples: x is the noise reference, d the noisy input
+// and e receives the saturated error. count may exceed maxBlock.
+void lms_q15_process(LMSQ15 *s, const short *x, const short *d, short *e, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LMS_Q15_H
@@ -0,0 +1,91 @@
+#include "lms_stream.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "simd_kernels.h"
+
+int lms_stream_init(LMSStream *s, int taps, float mu, int maxBlock) {
+    s->taps = taps;
+    s->maxBlock = maxBlock;
+    s->mu = mu;
+    s->normalized = 0;
+    s->eps = 0.0f;
+    s->weights = (float *)calloc(taps, sizeof(float));
+    s->history = (float *)calloc(taps - 1 + maxBlock, sizeof(float));
+
+    if (!s->weights || !s->history) {
+        lms_stream_free(s);
+        return -1;
+    }
+    return 0;
+}
+
+void lms_stream_enable_nlms(LMSStream *s, float eps) {
+    s->normalized = 1;
+    s->eps = eps;
+}
+
+void lms_stream_reset(LMSStream *s) {
+    memset(s->weights, 0, s->taps * sizeof(float));
+    memset(s->history, 0, (s->taps - 1 + s->maxBlock) * sizeof(float));
+}
+
+void lms_stream_free(LMSStream *s) {
+    free(s->weights);
+    free(s->history);
+    s->weights = NULL;
+    s->history = NULL;
+}
+
+static void process_block(LMSStream *s, const float *x, const float *d, float *e, int count) {
+    int taps = s->taps;
+    float *w = s->weights;
+    float *hist = s->history;
+
+    // The block goes right after the carried samples, so the taps-long window
+    // for sample n is hist[n .. n + taps - 1] (oldest first), even across
+    // block boundaries. The weights are stored in the same order, which keeps
+    // every load in the kernels contiguous.
+    memcpy(hist + taps - 1, x, count * sizeof(float));
+
+    // Compute filter output (estimated noise) for the first sample
+    float y = simd_dot_f32(w, hist, taps);
+    float g = 0.0f;
+
+    // NLMS: energy of the current window, computed exactly once per block and
+    // then slid one sample at a time so it never drifts far
+    double power = s->normalized ? simd_dot_f32(hist, hist, taps) : 0.0;
+
+    for (int n = 0; n < count; n++) {
+        // Apply the previous weight update and filter the current sample in one pass
+        if (n > 0) {
+            y = simd_lms_step_f32(w, hist + n - 1, g, hist + n, taps);
+
+            if (s->normalized) {
+                float in = hist[n + taps - 1], out = hist[n - 1];
+                power += (double)in * in - (double)out * out;
+                if (power < 0.0) power = 0.0;
+            }
+        }
+
+        e[n] = d[n] - y; // Error signal (clean audio)
+        g = s->normalized ? (float)(s->mu * e[n] / (s->eps + power)) : s->mu * e[n];
+    }
+
+    // Update filter weights for the last sample of the block
+    simd_axpy_f32(w, hist + count - 1, g, taps);
+
+    // Carry the newest taps - 1 samples over to the next block
+    memmove(hist, hist + count, (taps - 1) * sizeof(float));
+}
+
+void lms_stream_process(LMSStream *s, const float *x, const float *d, float *e, int count) {
+    while (count > 0) {
+        int block = count < s->maxBlock ? count : s->maxBlock;
+        process_block(s, x, d, e, block);
+        x += block;
+        d += block;
+        e += block;
+        count -= block;
+    }
+}
@@ -0,0 +1,43 @@
+// Streaming block LMS adaptive filter.
+//
+// Only the filter weights and the last (taps - 1) reference samples are kept
+// between calls, so input of any length can be pushed through in fixed-size
+// blocks with constant memory. Output for a block is available as soon as
+// lms_stream_process() returns.
+//
+// In NLMS mode the step is divided by the energy of the current tap window,
+// which is tracked with one add and one subtract per sample.
+#ifndef LMS_STREAM_H
+#define LMS_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int taps;
+    int maxBlock;
+    float mu;
+    int normalized;   // Non-zero for NLMS
+    float eps;        // NLMS regularization added to the window energy
+    float *weights;   // weights[taps - 1 - i] multiplies x[n - i] (oldest tap first)
+    float *history;   // (taps - 1) carried samples followed by the current block
+} LMSStream;
+
+// Returns 0 on success, -1 if the state could not be allocated
+int lms_stream_init(LMSStream *s, int taps, float mu, int maxBlock);
+void lms_stream_reset(LMSStream *s);
+void lms_stream_free(LMSStream *s);
+
+// Switch to normalized LMS: the step becomes mu / (eps + |x|^2)
+void lms_stream_enable_nlms(LMSStream *s, float eps);
+
+// Filter `count` samples: x is the noise reference, d the noisy input and
+// e receives the error (cleaned) signal. count may exceed maxBlock.
+void lms_stream_process(LMSStream *s, const float *x, const float *d, float *e, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LMS_STREAM_H
@@ -0,0 +1,116 @@
+#include "pcm_convert.h"
+#include "simd_kernels.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define DECODE_SAMPLES 4096   // Widened samples per mix, 16 KB of float
+#define KERNEL_FRAMES (1 << 24) // Frames per kernel call, well inside int
+
+static const char *encodingNames[] = {"unsupported", "8-bit PCM", "16-bit PCM", "24-bit PCM",
+                                      "32-bit PCM", "32-bit float", "64-bit float"};
+
+PCMEncoding pcm_encoding(const WAVFormat *fmt) {
+    int bytes = fmt->bitsPerSample / 8;
+    if (fmt->bitsPerSample % 8 != 0 || fmt->blockAlign != bytes * fmt->numChannels) return PCM_UNSUPPORTED;
+
+    if (fmt->audioFormat == WAV_FORMAT_PCM) {
+        switch (fmt->bitsPerSample) {
+        case 8: return PCM_U8;
+        case 16: return PCM_S16;
+        case 24: return PCM_S24;
+        case 32: return PCM_S32;
+        }
+    } else if (fmt->audioFormat == WAV_FORMAT_IEEE_FLOAT) {
+        if (fmt->bitsPerSample == 32) return PCM_F32;
+        if (fmt->bitsPerSample == 64) return PCM_F64;
+    }
+    return PCM_UNSUPPORTED;
+}
+
+const char *pcm_encoding_name(PCMEncoding encoding) {
+    return encodingNames[encoding];
+}
+
+// Widen count samples to float; the scale is applied by the mix
+static void widen(const unsigned char *src, PCMEncoding encoding, float *dst, int count) {
+    switch (encoding) {
+    case PCM_U8:
+        for (int i = 0; i < count; i++) dst[i] = (float)(src[i] - 128);
+        break;
+    case PCM_S24:
+        // Assemble each sample in the top three bytes so the shift sign-extends
+        for (int i = 0; i < count; i++) {
+            const unsigned char *p = src + 3 * i;
+            int v = (int)(((unsigned)p[0] << 8) | ((unsigned)p[1] << 16) | ((unsigned)p[2] << 24));
+            dst[i] = (float)(v >> 8);
+        }
+        break;
+    case PCM_F32:
+        for (int i = 0; i < count; i++) memcpy(&dst[i], src + 4 * (size_t)i, 4);
+        break;
+    case PCM_S32:
+        for (int i = 0; i < count; i++) {
+            int v;
+            memcpy(&v, src + 4 * (size_t)i, 4);
+            dst[i] = (float)v;
+        }
+        break;
+    case PCM_F64:
+        for (int i = 0; i < count; i++) {
+            double v;
+            memcpy(&v, src + 8 * (size_t)i, 8);
+            dst[i] = (float)v;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void pcm_to_mono(const void *src, PCMEncoding encoding, int channels, size_t frames, float *dst) {
+    static const float fullScale[] = {1.0f, 128.0f, 32768.0f, 8388608.0f, 2147483648.0f, 1.0f, 1.0f};
+    static const int sampleBytes[] = {0, 1, 2, 3, 4, 4, 8};
+    float scale = 1.0f / (fullScale[encoding] * channels);
+    const unsigned char *bytes = (const unsigned char *)src;
+
+    // 16-bit and float samples are used in place, in host order (see wav_io.h).
+    // RIFF only word-aligns the data chunk, so floats off a 4-byte boundary
+    // are widened like the other encodings
+    int floatAligned = ((uintptr_t)src % sizeof(float)) == 0;
+    if (encoding == PCM_S16 || (encoding == PCM_F32 && floatAligned)) {
+        for (size_t first = 0; first < frames; first += KERNEL_FRAMES) {
+            int count = frames - first < KERNEL_FRAMES ? (int)(frames - first) : KERNEL_FRAMES;
+            const void *block = bytes + first * channels * sampleBytes[encoding];
+            if (encoding == PCM_S16) {
+                simd_mix_i16_f32((const short *)block, channels, dst + first, scale, count);
+            } else {
+                simd_mix_f32((const float *)block, channels, dst + first, scale, count);
+            }
+        }
+        return;
+    }
+
+    float decoded[DECODE_SAMPLES];
+    if (channels > DECODE_SAMPLES) {
+        // Too wide for one block of frames: mix each frame on its own
+        for (size_t f = 0; f < frames; f++) {
+            const unsigned char *frame = bytes + f * channels * sampleBytes[encoding];
+            float sum = 0.0f;
+            for (int c = 0; c < channels; c += DECODE_SAMPLES) {
+                int count = channels - c < DECODE_SAMPLES ? channels - c : DECODE_SAMPLES;
+                widen(frame + (size_t)c * sampleBytes[encoding], encoding, decoded, count);
+                for (int i = 0; i < count; i++) sum += decoded[i];
+            }
+            dst[f] = sum * scale;
+        }
+        return;
+    }
+
+    int blockFrames = DECODE_SAMPLES / channels;
+    for (size_t first = 0; first < frames; first += blockFrames) {
+        int count = frames - first < (size_t)blockFrames ? (int)(frames - first) : blockFrames;
+        widen(bytes + first * channels * sampleBytes[encoding], encoding, decoded, count * channels);
+        simd_mix_f32(decoded, channels, dst + first, scale, count);
+    }
+}
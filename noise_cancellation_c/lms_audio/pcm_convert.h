@@ -0,0 +1,40 @@
+// Decoding of WAV sample data to float, with downmix to mono.
+//
+// Handles 8-bit (unsigned), 16-, 24- and 32-bit PCM and 32/64-bit IEEE
+// float, including WAVE_FORMAT_EXTENSIBLE files. 16-bit and float32 mono
+// or stereo input is converted straight from the mapped file by the SIMD
+// mix kernels; the other widths are widened to float a block at a time and
+// then mixed by the same kernels. Output is in [-1, 1) for every encoding.
+#ifndef PCM_CONVERT_H
+#define PCM_CONVERT_H
+
+#include <stddef.h>
+
+#include "wav_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PCM_UNSUPPORTED,
+    PCM_U8,
+    PCM_S16,
+    PCM_S24,
+    PCM_S32,
+    PCM_F32,
+    PCM_F64
+} PCMEncoding;
+
+// Encoding of a "fmt " chunk, PCM_UNSUPPORTED if it is none of the above
+PCMEncoding pcm_encoding(const WAVFormat *fmt);
+const char *pcm_encoding_name(PCMEncoding encoding);
+
+// dst[i] = mean of the channels of frame i of the interleaved src
+void pcm_to_mono(const void *src, PCMEncoding encoding, int channels, size_t frames, float *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCM_CONVERT_H
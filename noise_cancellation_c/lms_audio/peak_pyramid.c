@@ -0,0 +1,296 @@
+#include "peak_pyramid.h"
+#include "simd_kernels.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+
+#define PEAK_CACHE_VERSION 1
+#define READ_CHUNK 4096     // Buckets per channel read from the cache at once
+
+// The cache is a local derivative of the WAV, so it is written in native
+// byte order and rebuilt if anything in the header does not match.
+typedef struct {
+    char magic[8];
+    unsigned int version;
+    unsigned int channels;
+    unsigned long long frames;
+    unsigned long long wavSize;
+    long long wavTime;
+    unsigned long long bucketFrames[PEAK_LEVELS];
+} PeakCacheHeader;
+
+static const char cacheMagic[8] = "RXPEAKS";
+
+// Running envelope of a point being assembled
+typedef struct {
+    int min, max;
+    double sumSquares;
+    size_t frames;
+} Envelope;
+
+static void envelope_reset(Envelope *e) {
+    e->min = 32767;
+    e->max = -32768;
+    e->sumSquares = 0.0;
+    e->frames = 0;
+}
+
+static void envelope_add(Envelope *e, short min, short max, double sumSquares, size_t frames) {
+    if (min < e->min) e->min = min;
+    if (max > e->max) e->max = max;
+    e->sumSquares += sumSquares;
+    e->frames += frames;
+}
+
+static PeakBucket envelope_bucket(const Envelope *e) {
+    PeakBucket b;
+    b.min = (short)e->min;
+    b.max = (short)e->max;
+    b.rms = (float)sqrt(e->sumSquares / (double)e->frames);
+    return b;
+}
+
+static size_t bucket_frames(const PeakPyramid *p, int level, size_t bucket) {
+    size_t first = bucket * p->bucketFrames[level];
+    return p->frames - first < p->bucketFrames[level] ? p->frames - first : p->bucketFrames[level];
+}
+
+static void set_geometry(PeakPyramid *p, size_t frames, int channels) {
+    memset(p, 0, sizeof(*p));
+    p->channels = channels;
+    p->frames = frames;
+    size_t size = PEAK_BASE_BUCKET;
+    for (int l = 0; l < PEAK_LEVELS; l++) {
+        p->bucketFrames[l] = size;
+        p->buckets[l] = (frames + size - 1) / size;
+        size *= PEAK_LEVEL_RATIO;
+    }
+}
+
+int peak_pyramid_build(PeakPyramid *p, const short *samples, size_t frames, int channels) {
+    set_geometry(p, frames, channels);
+
+    size_t cells = p->buckets[0] * channels;
+    long long *sums = (long long *)malloc((cells ? cells : 1) * sizeof(long long));
+    short *plane = (short *)malloc(PEAK_BASE_BUCKET * sizeof(short));
+    int ok = sums && plane;
+    for (int l = 0; ok && l < PEAK_LEVELS; l++) {
+        p->levels[l] = (PeakBucket *)malloc((p->buckets[l] * channels + 1) * sizeof(PeakBucket));
+        ok = p->levels[l] != NULL;
+    }
+    if (!ok) {
+        free(sums);
+        free(plane);
+        peak_pyramid_free(p);
+        return -1;
+    }
+
+    // Base level: one pass over the samples, a bucket of every channel at a
+    // time so the deinterleaving stays in L1
+    for (size_t b = 0; b < p->buckets[0]; b++) {
+        int count = (int)bucket_frames(p, 0, b);
+        const short *block = samples + b * PEAK_BASE_BUCKET * channels;
+        for (int c = 0; c < channels; c++) {
+            const short *x = block;
+            if (channels > 1) {
+                for (int i = 0; i < count; i++) plane[i] = block[(size_t)i * channels + c];
+                x = plane;
+            }
+            PeakBucket *out = &p->levels[0][b * channels + c];
+            simd_peak_i16(x, count, &out->min, &out->max, &sums[b * channels + c]);
+            out->rms = (float)sqrt((double)sums[b * channels + c] / count);
+        }
+    }
+
+    // Coarser levels from the one below. The exact sums are folded in place:
+    // bucket b of the new level is written only after its children, which
+    // all sit at or beyond index b, have been read.
+    for (int l = 1; l < PEAK_LEVELS; l++) {
+        const PeakBucket *below = p->levels[l - 1];
+        for (size_t b = 0; b < p->buckets[l]; b++) {
+            size_t first = b * PEAK_LEVEL_RATIO;
+            size_t last = first + PEAK_LEVEL_RATIO < p->buckets[l - 1] ? first + PEAK_LEVEL_RATIO : p->buckets[l - 1];
+            for (int c = 0; c < channels; c++) {
+                int lo = 32767, hi = -32768;
+                long long sum = 0;
+                for (size_t k = first; k < last; k++) {
+                    const PeakBucket *child = &below[k * channels + c];
+                    if (child->min < lo) lo = child->min;
+                    if (child->max > hi) hi = child->max;
+                    sum += sums[k * channels + c];
+                }
+                PeakBucket *out = &p->levels[l][b * channels + c];
+                out->min = (short)lo;
+                out->max = (short)hi;
+                out->rms = (float)sqrt((double)sum / bucket_frames(p, l, b));
+                sums[b * channels + c] = sum;
+            }
+        }
+    }
+
+    free(sums);
+    free(plane);
+    return 0;
+}
+
+static int load_cache(PeakPyramid *p, const char *path, const struct stat *source, const WAVFile *wav) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+
+    PeakCacheHeader header;
+    set_geometry(p, wav->numFrames, wav->fmt.numChannels);
+    int ok = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, cacheMagic, 8) == 0 &&
+             header.version == PEAK_CACHE_VERSION && header.channels == (unsigned)p->channels &&
+             header.frames == p->frames && header.wavSize == (unsigned long long)source->st_size &&
+             header.wavTime == (long long)source->st_mtime;
+
+    long offset = (long)sizeof(header);
+    for (int l = 0; ok && l < PEAK_LEVELS; l++) {
+        ok = header.bucketFrames[l] == p->bucketFrames[l];
+        p->levelOffset[l] = offset;
+        offset += (long)(p->buckets[l] * p->channels * sizeof(PeakBucket));
+    }
+    // A truncated cache (e.g. an interrupted write) is rebuilt
+    ok = ok && fseek(file, 0, SEEK_END) == 0 && ftell(file) == offset;
+    if (ok) p->readBuffer = (PeakBucket *)malloc((size_t)READ_CHUNK * p->channels * sizeof(PeakBucket));
+    if (!ok || !p->readBuffer) {
+        fclose(file);
+        return -1;
+    }
+    p->cache = file;
+    return 0;
+}
+
+static int save_cache(const PeakPyramid *p, const char *path, const struct stat *source) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return -1;
+
+    PeakCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cacheMagic, 8);
+    header.version = PEAK_CACHE_VERSION;
+    header.channels = (unsigned)p->channels;
+    header.frames = p->frames;
+    header.wavSize = (unsigned long long)source->st_size;
+    header.wavTime = (long long)source->st_mtime;
+    for (int l = 0; l < PEAK_LEVELS; l++) header.bucketFrames[l] = p->bucketFrames[l];
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int l = 0; ok && l < PEAK_LEVELS; l++) {
+        size_t count = p->buckets[l] * p->channels;
+        ok = fwrite(p->levels[l], sizeof(PeakBucket), count, file) == count;
+    }
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) remove(path);
+    return ok ? 0 : -1;
+}
+
+int peak_pyramid_open(PeakPyramid *p, const char *wavPath, const WAVFile *wav) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s.peaks", wavPath);
+
+    struct stat source;
+    int haveSource = stat(wavPath, &source) == 0;
+    if (haveSource && load_cache(p, path, &source, wav) == 0) return 0;
+
+    const short *samples = wav_samples_i16(wav);
+    if (!samples) {
+        printf("Error: %s is not 16-bit PCM\n", wavPath);
+        return -1;
+    }
+    if (peak_pyramid_build(p, samples, wav->numFrames, wav->fmt.numChannels) != 0) {
+        printf("Error: Out of memory building the peak pyramid\n");
+        return -1;
+    }
+    if (haveSource && save_cache(p, path, &source) != 0) printf("Warning: Could not write %s\n", path);
+    return 0;
+}
+
+void peak_pyramid_free(PeakPyramid *p) {
+    for (int l = 0; l < PEAK_LEVELS; l++) {
+        free(p->levels[l]);
+        p->levels[l] = NULL;
+    }
+    free(p->readBuffer);
+    p->readBuffer = NULL;
+    if (p->cache) fclose(p->cache);
+    p->cache = NULL;
+}
+
+// Buckets [first, first + count) of a level, all channels; count <= READ_CHUNK
+static const PeakBucket *level_buckets(PeakPyramid *p, int level, size_t first, size_t count) {
+    if (p->levels[level]) return p->levels[level] + first * p->channels;
+
+    size_t cells = count * p->channels;
+    long offset = p->levelOffset[level] + (long)(first * p->channels * sizeof(PeakBucket));
+    if (fseek(p->cache, offset, SEEK_SET) != 0 || fread(p->readBuffer, sizeof(PeakBucket), cells, p->cache) != cells) {
+        return NULL;
+    }
+    return p->readBuffer;
+}
+
+static size_t query_samples(const PeakPyramid *p, const short *samples, int channel, size_t start, size_t end,
+                            size_t step, PeakBucket *out) {
+    short plane[PEAK_BASE_BUCKET];
+    size_t points = 0;
+    for (size_t from = start; from < end; from += step) {
+        int count = (int)(end - from < step ? end - from : step);
+        const short *x = samples + from * p->channels + channel;
+        if (p->channels > 1) {
+            for (int i = 0; i < count; i++) plane[i] = x[(size_t)i * p->channels];
+            x = plane;
+        }
+        long long sumSquares;
+        PeakBucket *b = &out[points++];
+        simd_peak_i16(x, count, &b->min, &b->max, &sumSquares);
+        b->rms = (float)sqrt((double)sumSquares / count);
+    }
+    return points;
+}
+
+size_t peak_pyramid_query(PeakPyramid *p, const short *samples, int channel, size_t start, size_t end,
+                          size_t maxPoints, PeakBucket *out, size_t *firstFrame, size_t *step) {
+    if (end > p->frames) end = p->frames;
+    if (start >= end || maxPoints == 0 || channel < 0 || channel >= p->channels) return 0;
+
+    // Frames each point has to cover, and the coarsest level that fits in it
+    size_t span = (end - start + maxPoints - 1) / maxPoints;
+    int level = -1;
+    for (int l = 0; l < PEAK_LEVELS; l++) {
+        if (p->bucketFrames[l] <= span) level = l;
+    }
+    if (level < 0) {
+        *firstFrame = start;
+        *step = span;
+        return query_samples(p, samples, channel, start, end, span, out);
+    }
+
+    // Whole buckets only, so the points line up with the pyramid
+    size_t frames = p->bucketFrames[level];
+    size_t first = start / frames;
+    size_t last = (end + frames - 1) / frames;
+    size_t group = (last - first + maxPoints - 1) / maxPoints;
+    *firstFrame = first * frames;
+    *step = group * frames;
+
+    size_t points = 0;
+    Envelope e;
+    envelope_reset(&e);
+    for (size_t b = first; b < last;) {
+        size_t count = last - b < READ_CHUNK ? last - b : READ_CHUNK;
+        const PeakBucket *chunk = level_buckets(p, level, b, count);
+        if (!chunk) return 0;
+        for (size_t k = 0; k < count; k++, b++) {
+            const PeakBucket *bucket = &chunk[k * p->channels + channel];
+            size_t n = bucket_frames(p, level, b);
+            envelope_add(&e, bucket->min, bucket->max, (double)bucket->rms * bucket->rms * n, n);
+            if ((b - first + 1) % group == 0 || b + 1 == last) {
+                out[points++] = envelope_bucket(&e);
+                envelope_reset(&e);
+            }
+        }
+    }
+    return points;
+}
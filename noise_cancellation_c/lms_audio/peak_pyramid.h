@@ -0,0 +1,58 @@
+// Multi-resolution min/max/RMS envelope of a 16-bit WAV file, for plotting.
+//
+// Level 0 summarises every PEAK_BASE_BUCKET frames of each channel and each
+// further level PEAK_LEVEL_RATIO times as many: 256, 4096 and 65536 frames
+// per bucket. The base level comes from one SIMD pass over the mapped
+// samples and the coarser ones from the level below, so the audio is read
+// once. peak_pyramid_open() caches the result next to the WAV as
+// "<file>.peaks" and rebuilds it when the WAV's size or modification time
+// changes; a cached pyramid stays on disk and queries only read the buckets
+// they need.
+#ifndef PEAK_PYRAMID_H
+#define PEAK_PYRAMID_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "wav_io.h"
+
+#define PEAK_LEVELS 3
+#define PEAK_BASE_BUCKET 256
+#define PEAK_LEVEL_RATIO 16
+
+typedef struct {
+    short min;
+    short max;
+    float rms;
+} PeakBucket;
+
+typedef struct {
+    int channels;
+    size_t frames;
+    size_t bucketFrames[PEAK_LEVELS];
+    size_t buckets[PEAK_LEVELS];        // Per channel
+    PeakBucket *levels[PEAK_LEVELS];    // buckets * channels, interleaved like the samples; NULL when on disk
+
+    FILE *cache;
+    long levelOffset[PEAK_LEVELS];
+    PeakBucket *readBuffer;
+} PeakPyramid;
+
+// Build the pyramid in memory from interleaved 16-bit samples.
+// Returns 0 on success, -1 if out of memory.
+int peak_pyramid_build(PeakPyramid *p, const short *samples, size_t frames, int channels);
+
+// Open the cached pyramid for wavPath, or build it from wav and write the
+// cache. Returns 0 on success, -1 (after printing why) on failure.
+int peak_pyramid_open(PeakPyramid *p, const char *wavPath, const WAVFile *wav);
+void peak_pyramid_free(PeakPyramid *p);
+
+// Envelope of frames [start, end) of one channel in at most maxPoints
+// points, taken from the coarsest level that still gives maxPoints points
+// (or straight from samples when zoomed in past the base level). Point k
+// starts at frame *firstFrame + k * *step. Returns the number of points,
+// or 0 if the range is empty or the cache could not be read.
+size_t peak_pyramid_query(PeakPyramid *p, const short *samples, int channel, size_t start, size_t end,
+                          size_t maxPoints, PeakBucket *out, size_t *firstFrame, size_t *step);
+
+#endif // PEAK_PYRAMID_H
@@ -1,67 +1,113 @@
-//plotting of the .wav files:
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdint.h>
-
-#define WAV_HEADER_SIZE 44  // Standard WAV file header size
-
-void plot_waveform(const char *data_file) {
-    //FILE *gnuplot = popen("gnuplot -persistent", "w");
-    FILE *gnuplot = popen("\"D:\\gnuplot\\bin\\gnuplot.exe\" -persistent", "w");
-    if (!gnuplot) {
-        fprintf(stderr, "Error opening GNUplot.\n");
-        return;
-    }
-    fprintf(gnuplot, "set title 'WAV File Waveform'\n");
-    fprintf(gnuplot, "set xlabel 'Sample Index'\n");
-    fprintf(gnuplot, "set ylabel 'Amplitude'\n");
-    fprintf(gnuplot, "plot '%s' with lines title 'Audio Waveform'\n", data_file);
-    pclose(gnuplot);
-}
-
-void read_wav_data(const char *wav_filename, const char *output_data_filename) {
-    FILE *wav_file = fopen(wav_filename, "rb");
-    if (!wav_file) {
-        fprintf(stderr, "Error opening WAV file.\n");
-        return;
-    }
-
-    FILE *data_file = fopen(output_data_filename, "w");
-    if (!data_file) {
-        fprintf(stderr, "Error creating output data file.\n");
-        fclose(wav_file);
-        return;
-    }
-
-    // Skip WAV header
-    fseek(wav_file, WAV_HEADER_SIZE, SEEK_SET);
-
-    int16_t sample;
-    int index = 0;
-
-    // Read samples and write them to the output file
-    while (fread(&sample, sizeof(int16_t), 1, wav_file)) {
-        fprintf(data_file, "%d %d\n", index++, sample);
-    }
-
-    fclose(wav_file);
-    fclose(data_file);
-}
-
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        printf("Usage: %s <wav_file>\n", argv[0]);
-        return 1;
-    }
-
-    const char *wav_filename = argv[1];
-    const char *data_filename = "waveform.dat";
-
-    // Read WAV file and generate data
-    read_wav_data(wav_filename, data_filename);
-
-    // Plot waveform using GNUplot
-    plot_waveform(data_filename);
-
-    return 0;
-}
+//plotting of the .wav files:
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "peak_pyramid.h"
+#include "wav_io.h"
+
+#define DEFAULT_POINTS 4000   // About one point per horizontal pixel
+
+// envelope is 0 when every point is a single sample
+void plot_waveform(const char *data_file, int envelope) {
+    //FILE *gnuplot = popen("gnuplot -persistent", "w");
+    FILE *gnuplot = popen("\"D:\\gnuplot\\bin\\gnuplot.exe\" -persistent", "w");
+    if (!gnuplot) {
+        fprintf(stderr, "Error opening GNUplot.\n");
+        return;
+    }
+    fprintf(gnuplot, "set title 'WAV File Waveform'\n");
+    fprintf(gnuplot, "set xlabel 'Sample Index'\n");
+    fprintf(gnuplot, "set ylabel 'Amplitude'\n");
+    if (envelope) {
+        fprintf(gnuplot, "plot '%s' using 1:2:3 with filledcurves title 'Min/Max', "
+                         "'' using 1:4 with lines title 'RMS', '' using 1:(-$4) with lines notitle\n", data_file);
+    } else {
+        fprintf(gnuplot, "plot '%s' using 1:2 with lines title 'Audio Waveform'\n", data_file);
+    }
+    pclose(gnuplot);
+}
+
+// Writes "index min max rms" lines for frames [start, end) of one channel.
+// Returns the frames per point, or 0 on failure.
+size_t write_envelope(const char *wav_filename, const char *output_data_filename, int channel,
+                      size_t start, size_t end, size_t points) {
+    WAVFile wav;
+    if (wav_open(wav_filename, &wav) != 0) return 0;
+
+    const short *samples = wav_samples_i16(&wav);
+    if (!samples) {
+        fprintf(stderr, "Error: %s is not 16-bit PCM.\n", wav_filename);
+        wav_close(&wav);
+        return 0;
+    }
+    if (channel >= wav.fmt.numChannels) {
+        fprintf(stderr, "Error: %s has %d channel(s).\n", wav_filename, wav.fmt.numChannels);
+        wav_close(&wav);
+        return 0;
+    }
+
+    PeakPyramid pyramid;
+    if (peak_pyramid_open(&pyramid, wav_filename, &wav) != 0) {
+        wav_close(&wav);
+        return 0;
+    }
+
+    PeakBucket *envelope = (PeakBucket *)malloc(points * sizeof(PeakBucket));
+    size_t first = 0, step = 0, count = 0;
+    if (envelope) count = peak_pyramid_query(&pyramid, samples, channel, start, end, points, envelope, &first, &step);
+
+    FILE *data_file = count ? fopen(output_data_filename, "w") : NULL;
+    if (data_file) {
+        for (size_t i = 0; i < count; i++) {
+            fprintf(data_file, "%llu %d %d %.1f\n", (unsigned long long)(first + i * step), envelope[i].min,
+                    envelope[i].max, envelope[i].rms);
+        }
+        fclose(data_file);
+    } else {
+        fprintf(stderr, count ? "Error creating output data file.\n" : "Error: Nothing to plot in that range.\n");
+        step = 0;
+    }
+
+    free(envelope);
+    peak_pyramid_free(&pyramid);
+    wav_close(&wav);
+    return step;
+}
+
+int main(int argc, char *argv[]) {
+    size_t start = 0, end = (size_t)-1, points = DEFAULT_POINTS;
+    int channel = 0;
+
+    int arg = 1;
+    for (; arg + 1 < argc && strncmp(argv[arg], "--", 2) == 0; arg += 2) {
+        if (strcmp(argv[arg], "--from") == 0) {
+            start = (size_t)strtoull(argv[arg + 1], NULL, 10);
+        } else if (strcmp(argv[arg], "--to") == 0) {
+            end = (size_t)strtoull(argv[arg + 1], NULL, 10);
+        } else if (strcmp(argv[arg], "--points") == 0) {
+            points = (size_t)strtoull(argv[arg + 1], NULL, 10);
+        } else if (strcmp(argv[arg], "--channel") == 0) {
+            channel = atoi(argv[arg + 1]);
+        } else {
+            break;
+        }
+    }
+
+    if (argc - arg != 1 || points == 0 || channel < 0) {
+        printf("Usage: %s [--from FRAME] [--to FRAME] [--points N] [--channel C] <wav_file>\n", argv[0]);
+        return 1;
+    }
+
+    const char *wav_filename = argv[arg];
+    const char *data_filename = "waveform.dat";
+
+    // Summarise the requested range from the cached peak pyramid
+    size_t step = write_envelope(wav_filename, data_filename, channel, start, end, points);
+    if (!step) return 1;
+
+    // Plot waveform using GNUplot
+    plot_waveform(data_filename, step > 1);
+
+    return 0;
+}
@@ -1,115 +1,87 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-
-#define FRAME_SIZE 1024
-#define PREDICTION_ORDER 3  // Number of past samples to use for prediction
-
-// WAV header structure
-typedef struct {
-    char chunkID[4];
-    int chunkSize;
-    char format[4];
-    char subchunk1ID[4];
-    int subchunk1Size;
-    short audioFormat;
-    short numChannels;
-    int sampleRate;
-    int byteRate;
-    short blockAlign;
-    short bitsPerSample;
-    char subchunk2ID[4];
-    int subchunk2Size;
-} WAVHeader;
-
-// Predict noise using an Auto-Regressive (AR) Model
-short predict_noise(short *noise_history) {
-    // Simple AR model: Weighted sum of past samples
-    float weights[PREDICTION_ORDER] = {0.5, -0.3, 0.2}; // Example coefficients
-    float predicted_value = 0.0;
-
-    for (int i = 0; i < PREDICTION_ORDER; i++) {
-        predicted_value += weights[i] * noise_history[i];
-    }
-
-    return (short)predicted_value;
-}
-
-// Adaptive Noise Cancellation using Predictive Filtering
-void predictive_anc(short *input, short *output, int numSamples) {
-    short noise_history[PREDICTION_ORDER] = {0};
-
-    for (int i = 0; i < numSamples; i++) {
-        // Predict noise from previous samples
-        short predicted_noise = predict_noise(noise_history);
-
-        // Remove predicted noise from the current input sample
-        output[i] = input[i] - predicted_noise;
-
-        // Update noise history
-        for (int j = PREDICTION_ORDER - 1; j > 0; j--) {
-            noise_history[j] = noise_history[j - 1];
-        }
-        noise_history[0] = input[i]; // Store current input as next history sample
-    }
-}
-
-// Read WAV file
-short *read_wav(const char *filename, WAVHeader *header, int *numSamples) {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        printf("Error opening input file!\n");
-        return NULL;
-    }
-
-    fread(header, sizeof(WAVHeader), 1, file);
-    *numSamples = header->subchunk2Size / sizeof(short);
-    
-    short *data = (short *)malloc(*numSamples * sizeof(short));
-    fread(data, sizeof(short), *numSamples, file);
-    fclose(file);
-    return data;
-}
-
-// Write WAV file
-void write_wav(const char *filename, WAVHeader *header, short *data, int numSamples) {
-    FILE *file = fopen(filename, "wb");
-    if (!file) {
-        printf("Error opening output file!\n");
-        return;
-    }
-
-    fwrite(header, sizeof(WAVHeader), 1, file);
-    fwrite(data, sizeof(short), numSamples, file);
-    fclose(file);
-}
-
-int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        printf("Usage: %s <input.wav> <output.wav>\n", argv[0]);
-        return 1;
-    }
-
-    WAVHeader header;
-    int numSamples;
-
-    // Read input WAV file
-    short *input = read_wav(argv[1], &header, &numSamples);
-    if (!input) return 1;
-
-    // Allocate memory for output
-    short *output = (short *)malloc(numSamples * sizeof(short));
-
-    // Apply Predictive ANC
-    predictive_anc(input, output, numSamples);
-
-    // Write output WAV file
-    write_wav(argv[2], &header, output, numSamples);
-
-    // Clean up
-    free(input);
-    free(output);
-
-    printf("Noise cancellation completed. Output saved to %s\n", argv[2]);
-    return 0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "wav_io.h"
+#include "anc_engine.h"
+#include "fft.h"
+
+#define FRAME_SIZE 1024
+#define PREDICTION_ORDER 3  // Number of past samples to use for prediction
+
+int main(int argc, char *argv[]) {
+    // --lpc re-fits the AR model to every frame instead of using fixed
+    // coefficients; --stft suppresses the noise floor in the frequency domain
+    const char *engine = "predict";
+    int order = PREDICTION_ORDER;
+    int arg = 1;
+    if (arg + 1 < argc && (strcmp(argv[arg], "--lpc") == 0 || strcmp(argv[arg], "--stft") == 0)) {
+        engine = argv[arg] + 2;
+        order = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (argc - arg != 2 || order <= 0) {
+        printf("Usage: %s [--lpc ORDER | --stft FRAME] <input.wav> <output.wav>\n", argv[0]);
+        return 1;
+    }
+
+    WAVFile inputWav;
+
+    // Read input WAV file
+    if (wav_open(argv[arg], &inputWav) != 0) return 1;
+
+    const short *input = wav_samples_i16(&inputWav);
+    if (!input) {
+        printf("Error: Only 16-bit PCM WAV files are supported!\n");
+        wav_close(&inputWav);
+        return 1;
+    }
+    int channels = inputWav.fmt.numChannels;
+    size_t frames = inputWav.numFrames;
+
+    // Allocate memory for output
+    short *output = (short *)malloc(inputWav.numSamples * sizeof(short));
+    if (!output) {
+        printf("Error: Out of memory\n");
+        wav_close(&inputWav);
+        return 1;
+    }
+
+    // Run each channel through its own engine, FRAME_SIZE samples at a
+    // time. Samples held back by the engine's latency are flushed out with
+    // silence and the output is shifted back by as much.
+    short in[FRAME_SIZE], out[FRAME_SIZE];
+    for (int c = 0; c < channels; c++) {
+        ANCEngine *predictor = anc_engine_create(engine, order, 0.0f, FRAME_SIZE);
+        if (!predictor) {
+            printf("Error: Could not set up %s with %s %d\n", engine, strcmp(engine, "stft") == 0 ? "frame" : "order",
+                   order);
+            wav_close(&inputWav);
+            free(output);
+            fft_plan_cache_free();
+            return 1;
+        }
+        size_t latency = predictor->latency;
+        for (size_t pos = 0; pos < frames + latency; pos += FRAME_SIZE) {
+            int n = frames + latency - pos < FRAME_SIZE ? (int)(frames + latency - pos) : FRAME_SIZE;
+            for (int i = 0; i < n; i++) in[i] = pos + i < frames ? input[(pos + i) * channels + c] : 0;
+            anc_engine_process_i16(predictor, NULL, in, out, n);
+            for (int i = 0; i < n; i++) {
+                if (pos + i >= latency) output[(pos + i - latency) * channels + c] = out[i];
+            }
+        }
+        anc_engine_destroy(predictor);
+    }
+    fft_plan_cache_free();
+
+    // Write output WAV file
+    int status = wav_write_i16(argv[arg + 1], &inputWav.fmt, output, inputWav.numSamples);
+
+    // Clean up
+    wav_close(&inputWav);
+    free(output);
+    if (status != 0) return 1;
+
+    printf("Noise cancellation completed. Output saved to %s\n", argv[arg + 1]);
+    return 0;
+}
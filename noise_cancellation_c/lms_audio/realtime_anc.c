@@ -0,0 +1,394 @@
+// Real-time noise cancellation over a file-backed virtual device.
+//
+// Three threads are joined by lock-free SPSC rings:
+//   capture  - delivers one block of the noisy and noise recordings every
+//              block period, paced at the WAV sample rate
+//   dsp      - runs one engine per channel on each block
+//   playback - consumes one cleaned block per period, after PREFILL_BLOCKS
+//              periods of buffering, and writes it to the output WAV
+// A full input ring drops the captured block (overrun); an empty output ring
+// at a playback tick plays silence (underrun). At the end the tool reports
+// per-block processing time, xrun counts and input-to-output latency.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "wav_io.h"
+#include "anc_engine.h"
+#include "channel_pipeline.h"
+#include "spsc_ring.h"
+
+#define BLOCK_FRAMES 256    // Frames per device period
+#define RING_BLOCKS 8       // Slots in each ring
+#define PREFILL_BLOCKS 1    // Periods of output buffered before playback starts
+
+// Leads every ring slot; the interleaved samples follow it
+typedef struct {
+    double captured;   // When the first frame of the block was captured
+    int frames;
+} BlockHeader;
+
+typedef struct {
+    // Virtual device
+    const short *noisy;
+    const short *noise;
+    int channels;
+    int refChannels;
+    size_t frames;
+    FILE *output;
+    size_t written;        // Frames played, silence included
+    int writeError;
+
+    // Timing, in wall-clock seconds
+    int blockFrames;
+    int prefill;
+    double period;
+    double start;
+
+    SPSCRing in;           // capture -> dsp
+    SPSCRing out;          // dsp -> playback
+    atomic_int captureDone;
+    atomic_int dspDone;
+
+    const char *engine;
+    ANCEngine **engines;   // One per channel
+    ChannelPipeline pipeline;
+
+    // Statistics, each written by a single thread
+    long blocks;
+    double *procTime;      // Per processed block (dsp)
+    long processed;
+    double *latency;       // Per played block (playback)
+    long played;
+    long overruns;         // Captured blocks dropped on a full input ring
+    long underruns;        // Playback periods filled with silence
+} Session;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void sleep_until(double deadline) {
+#ifdef _WIN32
+    double wait = deadline - now_seconds();
+    if (wait > 0.0) Sleep((DWORD)(wait * 1000.0));
+#else
+    struct timespec ts;
+    ts.tv_sec = (time_t)deadline;
+    ts.tv_nsec = (long)((deadline - (double)ts.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+#endif
+}
+
+static short *block_samples(BlockHeader *h) {
+    return (short *)((unsigned char *)h + sizeof(BlockHeader));
+}
+
+static void *capture_thread(void *arg) {
+    Session *s = (Session *)arg;
+
+    for (long k = 0; k < s->blocks; k++) {
+        // Block k is complete once its period has elapsed
+        sleep_until(s->start + (k + 1) * s->period);
+
+        BlockHeader *h = (BlockHeader *)spsc_ring_write_slot(&s->in);
+        if (!h) {
+            s->overruns++;
+            continue;
+        }
+
+        size_t pos = (size_t)k * s->blockFrames;
+        int frames = (int)(s->frames - pos < (size_t)s->blockFrames ? s->frames - pos : (size_t)s->blockFrames);
+        short *samples = block_samples(h);
+
+        h->captured = s->start + k * s->period;
+        h->frames = frames;
+        memcpy(samples, s->noisy + pos * s->channels, (size_t)frames * s->channels * sizeof(short));
+        memcpy(samples + (size_t)frames * s->channels, s->noise + pos * s->refChannels,
+               (size_t)frames * s->refChannels * sizeof(short));
+        spsc_ring_commit(&s->in);
+    }
+
+    atomic_store(&s->captureDone, 1);
+    return NULL;
+}
+
+static void process_block(Session *s, BlockHeader *in, BlockHeader *out) {
+    int frames = in->frames;
+    const short *noisy = block_samples(in);
+    const short *noise = noisy + (size_t)frames * s->channels;
+
+    channel_pipeline_run(&s->pipeline, noisy, noise, frames);
+    channel_pipeline_interleave(&s->pipeline, 0, frames, block_samples(out));
+
+    out->captured = in->captured;
+    out->frames = frames;
+}
+
+static void *dsp_thread(void *arg) {
+    Session *s = (Session *)arg;
+    double nap = s->period / 8;
+
+    for (;;) {
+        BlockHeader *in = (BlockHeader *)spsc_ring_read_slot(&s->in);
+        if (!in) {
+            if (atomic_load(&s->captureDone) && !spsc_ring_read_slot(&s->in)) break;
+            sleep_until(now_seconds() + nap);
+            continue;
+        }
+
+        // Playback drains one slot per period, so a full ring frees up soon
+        BlockHeader *out;
+        while (!(out = (BlockHeader *)spsc_ring_write_slot(&s->out))) {
+            sleep_until(now_seconds() + nap);
+        }
+
+        double t0 = now_seconds();
+        process_block(s, in, out);
+        s->procTime[s->processed++] = now_seconds() - t0;
+
+        spsc_ring_release(&s->in);
+        spsc_ring_commit(&s->out);
+    }
+
+    atomic_store(&s->dspDone, 1);
+    return NULL;
+}
+
+static void *playback_thread(void *arg) {
+    Session *s = (Session *)arg;
+    size_t silenceSize = (size_t)s->blockFrames * s->channels;
+    short *silence = (short *)calloc(silenceSize, sizeof(short));
+
+    for (long tick = 0;; tick++) {
+        // The first cleaned block can exist one period after capture starts
+        sleep_until(s->start + (tick + 1 + s->prefill) * s->period);
+
+        BlockHeader *h = (BlockHeader *)spsc_ring_read_slot(&s->out);
+        if (!h) {
+            if (atomic_load(&s->dspDone) && !spsc_ring_read_slot(&s->out)) break;
+            s->underruns++;
+            if (silence && fwrite(silence, sizeof(short), silenceSize, s->output) != silenceSize) s->writeError = 1;
+            s->written += s->blockFrames;
+            continue;
+        }
+
+        size_t count = (size_t)h->frames * s->channels;
+        s->latency[s->played++] = now_seconds() - h->captured;
+        if (fwrite(block_samples(h), sizeof(short), count, s->output) != count) s->writeError = 1;
+        s->written += h->frames;
+        spsc_ring_release(&s->out);
+    }
+
+    free(silence);
+    return NULL;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+// p in [0, 1] of an array sorted in place
+static double percentile(double *values, long count, double p) {
+    if (count == 0) return 0.0;
+    long index = (long)(p * count + 0.5) - 1;
+    if (index < 0) index = 0;
+    if (index >= count) index = count - 1;
+    return values[index];
+}
+
+static void report(Session *s, int sampleRate, double speed) {
+    double budget = s->period;
+    double total = 0.0;
+    long late = 0;
+
+    for (long i = 0; i < s->processed; i++) {
+        total += s->procTime[i];
+        if (s->procTime[i] > budget) late++;
+    }
+    qsort(s->procTime, s->processed, sizeof(double), compare_double);
+    qsort(s->latency, s->played, sizeof(double), compare_double);
+
+    printf("Engine %s, %d channel(s), %d-frame blocks at %d Hz, %.2f ms period (speed %.1fx)\n",
+           s->engine, s->channels, s->blockFrames, sampleRate, budget * 1e3, speed);
+    printf("Processing per block: mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms; %ld over budget\n",
+           s->processed ? total / s->processed * 1e3 : 0.0, percentile(s->procTime, s->processed, 0.50) * 1e3,
+           percentile(s->procTime, s->processed, 0.99) * 1e3, percentile(s->procTime, s->processed, 1.0) * 1e3,
+           late);
+    printf("Xruns: %ld capture overrun(s), %ld playback underrun(s)\n", s->overruns, s->underruns);
+    printf("Input-to-output latency: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           percentile(s->latency, s->played, 0.50) * 1e3, percentile(s->latency, s->played, 0.95) * 1e3,
+           percentile(s->latency, s->played, 0.99) * 1e3, percentile(s->latency, s->played, 1.0) * 1e3);
+    if (s->engines[0]->latency > 0) {
+        printf("The engine adds %d samples (%.2f ms) of algorithmic delay on top\n", s->engines[0]->latency,
+               s->engines[0]->latency * 1e3 / sampleRate);
+    }
+}
+
+static int engines_init(Session *s, int taps, float mu) {
+    s->engines = (ANCEngine **)calloc(s->channels, sizeof(ANCEngine *));
+    if (!s->engines) return -1;
+
+    for (int ch = 0; ch < s->channels; ch++) {
+        s->engines[ch] = anc_engine_create(s->engine, taps, mu, s->blockFrames);
+        if (!s->engines[ch]) return -1;
+    }
+    return channel_pipeline_init(&s->pipeline, s->channels, s->refChannels, s->blockFrames, s->engines, NULL);
+}
+
+static void engines_free(Session *s) {
+    for (int ch = 0; s->engines && ch < s->channels; ch++) anc_engine_destroy(s->engines[ch]);
+    free(s->engines);
+    channel_pipeline_free(&s->pipeline);
+}
+
+int main(int argc, char *argv[]) {
+    const char *engine = "lms";
+    int taps = 0;        // Engine default unless --taps is given
+    float mu = 0.0f;     // Engine default unless --mu is given
+    int blockFrames = BLOCK_FRAMES;
+    int prefill = PREFILL_BLOCKS;
+    double speed = 1.0;
+
+    int arg = 1;
+    for (; arg + 1 < argc && strncmp(argv[arg], "--", 2) == 0; arg += 2) {
+        if (strcmp(argv[arg], "--engine") == 0) {
+            if (!anc_engine_find(argv[arg + 1])) break;
+            engine = argv[arg + 1];
+        } else if (strcmp(argv[arg], "--taps") == 0) {
+            taps = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--mu") == 0) {
+            mu = (float)atof(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--block") == 0) {
+            blockFrames = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--prefill") == 0) {
+            prefill = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--speed") == 0) {
+            speed = atof(argv[arg + 1]);
+        } else {
+            break;
+        }
+    }
+
+    if (argc - arg != 3 || taps < 0 || mu < 0.0f || blockFrames <= 0 || prefill < 0 || speed <= 0.0) {
+        printf("Usage: %s [--engine %s] [--taps N] [--mu MU] [--block FRAMES] [--prefill BLOCKS] [--speed X] <noisy.wav> <noise.wav> <output.wav>\n",
+               argv[0], anc_engine_names("|"));
+        return 1;
+    }
+
+    WAVFile noisyWav, noiseWav;
+    if (wav_open(argv[arg], &noisyWav) != 0) return -1;
+    if (wav_open(argv[arg + 1], &noiseWav) != 0) {
+        wav_close(&noisyWav);
+        return -1;
+    }
+
+    Session s;
+    memset(&s, 0, sizeof(s));
+    s.noisy = wav_samples_i16(&noisyWav);
+    s.noise = wav_samples_i16(&noiseWav);
+    s.channels = noisyWav.fmt.numChannels;
+    s.refChannels = noiseWav.fmt.numChannels;
+    if (!s.noisy || !s.noise || (s.refChannels != s.channels && s.refChannels != 1)) {
+        printf("Error: Need 16-bit PCM input with a mono or matching noise reference\n");
+        wav_close(&noisyWav);
+        wav_close(&noiseWav);
+        return -1;
+    }
+
+    s.frames = noisyWav.numFrames < noiseWav.numFrames ? noisyWav.numFrames : noiseWav.numFrames;
+    s.blockFrames = blockFrames;
+    s.prefill = prefill;
+    s.period = (double)blockFrames / noisyWav.fmt.sampleRate / speed;
+    s.engine = engine;
+    s.blocks = (long)((s.frames + blockFrames - 1) / blockFrames);
+    atomic_init(&s.captureDone, 0);
+    atomic_init(&s.dspDone, 0);
+
+    size_t slotSize = sizeof(BlockHeader) + (size_t)blockFrames * (s.channels + s.refChannels) * sizeof(short);
+    int status = 0;
+    if (spsc_ring_init(&s.in, RING_BLOCKS, slotSize) != 0) status = -1;
+    if (spsc_ring_init(&s.out, RING_BLOCKS, slotSize) != 0) status = -1;
+    s.procTime = (double *)malloc((s.blocks + 1) * sizeof(double));
+    s.latency = (double *)malloc((s.blocks + 1) * sizeof(double));
+    if (!s.procTime || !s.latency) status = -1;
+    if (status == 0 && engines_init(&s, taps, mu) != 0) status = -1;
+    if (status != 0) printf("Error: Cannot set up the filters\n");
+
+    if (status == 0) {
+        s.output = fopen(argv[arg + 2], "wb");
+        if (!s.output) {
+            printf("Error creating output file!\n");
+            status = -1;
+        }
+    }
+
+    if (status == 0 && wav_write_header(s.output, &noisyWav.fmt, 0) != 0) {
+        printf("Error writing output file!\n");
+        fclose(s.output);
+        status = -1;
+    }
+
+    if (status == 0) {
+        pthread_t capture, dsp, playback;
+        s.start = now_seconds();
+
+        // Threads start downstream first. When one cannot be started its
+        // done flag is raised in its place, so the threads already running
+        // drain their rings and exit; only those are joined.
+        int started = pthread_create(&playback, NULL, playback_thread, &s) == 0;
+        if (started == 1) {
+            started += pthread_create(&dsp, NULL, dsp_thread, &s) == 0;
+            if (started == 1) atomic_store(&s.dspDone, 1);
+        }
+        if (started == 2) {
+            started += pthread_create(&capture, NULL, capture_thread, &s) == 0;
+            if (started == 2) atomic_store(&s.captureDone, 1);
+        }
+        if (started == 3) pthread_join(capture, NULL);
+        if (started >= 2) pthread_join(dsp, NULL);
+        if (started >= 1) pthread_join(playback, NULL);
+        if (started < 3) {
+            printf("Error: Cannot start the audio threads\n");
+            status = -1;
+        }
+
+        if (wav_update_sizes(s.output, s.written * noisyWav.fmt.blockAlign) != 0) s.writeError = 1;
+        if (fclose(s.output) != 0) s.writeError = 1;
+        if (s.writeError) {
+            printf("Error writing output file!\n");
+            status = -1;
+        }
+
+        if (started == 3) {
+            report(&s, noisyWav.fmt.sampleRate, speed);
+
+            long resets = 0;
+            for (int ch = 0; ch < s.channels; ch++) resets += s.engines[ch]->resets;
+            if (resets > 0) printf("Lattice RLS re-initialized %ld time(s) after numerical divergence\n", resets);
+        }
+    }
+
+    // Cleanup
+    engines_free(&s);
+    spsc_ring_free(&s.in);
+    spsc_ring_free(&s.out);
+    free(s.procTime);
+    free(s.latency);
+    wav_close(&noisyWav);
+    wav_close(&noiseWav);
+
+    if (status != 0) return -1;
+    printf("Real-time output saved as '%s'.\n", argv[arg + 2]);
+    return 0;
+}
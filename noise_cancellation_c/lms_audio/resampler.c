@@ -0,0 +1,141 @@
+#include "resampler.h"
+#include "simd_kernels.h"
+#include "dsp_math.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#define ZERO_CROSSINGS 16     // Sinc lobes on each side of the centre, at the cutoff frequency
+#define CUTOFF 0.95           // Fraction of the lower Nyquist rate kept
+#define KAISER_BETA 8.6       // About 90 dB of stopband attenuation
+
+static int gcd(int a, int b) {
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Row p holds the taps, oldest input first, for an output p / phases of a
+// sample after input taps / 2 - 1 of its window. Each row sums to 1, so DC
+// passes unchanged at every phase.
+static void build_table(Resampler *r, double cutoff) {
+    int half = r->taps / 2;
+    double norm = bessel_i0(KAISER_BETA);
+    for (int p = 0; p <= r->phases; p++) {
+        float *row = r->coeffs + (size_t)p * r->taps;
+        double frac = (double)p / r->phases, sum = 0.0;
+        for (int j = 0; j < r->taps; j++) {
+            double d = frac + half - 1 - j;   // Distance from input j to the output
+            double x = d / half;
+            double window = fabs(x) < 1.0 ? bessel_i0(KAISER_BETA * sqrt(1.0 - x * x)) / norm : 0.0;
+            double sinc = d == 0.0 ? 1.0 : sin(DSP_PI * cutoff * d) / (DSP_PI * cutoff * d);
+            row[j] = (float)(cutoff * sinc * window);
+            sum += row[j];
+        }
+        for (int j = 0; j < r->taps; j++) row[j] = (float)(row[j] / sum);
+    }
+}
+
+int resampler_init(Resampler *r, int inRate, int outRate, int maxBlock) {
+    memset(r, 0, sizeof(*r));
+    if (inRate <= 0 || outRate <= 0 || maxBlock <= 0) return -1;
+
+    int g = gcd(inRate, outRate);
+    r->up = outRate / g;
+    r->down = inRate / g;
+    r->phases = r->up < RESAMPLER_MAX_PHASES ? r->up : RESAMPLER_MAX_PHASES;
+
+    // Downsampling lowers the cutoff, and the filter widens to keep the
+    // same number of lobes
+    double cutoff = CUTOFF * (r->up < r->down ? (double)r->up / r->down : 1.0);
+    int half = (int)ceil(ZERO_CROSSINGS / cutoff);
+    r->taps = (2 * half + 7) & ~7;
+
+    r->maxBlock = maxBlock > r->taps ? maxBlock : r->taps;
+    r->capacity = r->taps + r->maxBlock;
+    r->coeffs = (float *)malloc((size_t)(r->phases + 1) * r->taps * sizeof(float));
+    r->buffer = (float *)malloc((size_t)r->capacity * sizeof(float));
+    if (!r->coeffs || !r->buffer) {
+        resampler_free(r);
+        return -1;
+    }
+
+    build_table(r, cutoff);
+    resampler_reset(r);
+    return 0;
+}
+
+void resampler_reset(Resampler *r) {
+    // taps / 2 - 1 zeros of history centre the first window on input 0
+    r->fill = r->taps / 2 - 1;
+    memset(r->buffer, 0, r->fill * sizeof(float));
+    r->pos = 0;
+    r->phase = 0;
+    r->inFrames = 0;
+    r->outFrames = 0;
+}
+
+void resampler_free(Resampler *r) {
+    free(r->coeffs);
+    free(r->buffer);
+    r->coeffs = r->buffer = NULL;
+}
+
+int resampler_max_output(const Resampler *r, int inCount) {
+    return (int)(((long long)(inCount + r->taps) * r->up) / r->down) + 1;
+}
+
+// Outputs whose window is complete in the buffer, up to `limit` in total
+static int produce(Resampler *r, float *out, long long limit) {
+    int count = 0;
+    while (r->pos + r->taps <= r->fill && r->outFrames < limit) {
+        const float *x = r->buffer + r->pos;
+        float y;
+        if (r->phases == r->up) {
+            y = simd_dot_f32(r->coeffs + (size_t)r->phase * r->taps, x, r->taps);
+        } else {
+            long long scaled = (long long)r->phase * r->phases;
+            int row = (int)(scaled / r->up);
+            float t = (float)(scaled % r->up) / r->up;
+            float y0 = simd_dot_f32(r->coeffs + (size_t)row * r->taps, x, r->taps);
+            float y1 = simd_dot_f32(r->coeffs + (size_t)(row + 1) * r->taps, x, r->taps);
+            y = y0 + t * (y1 - y0);
+        }
+        out[count++] = y;
+        r->outFrames++;
+
+        r->phase += r->down;
+        r->pos += r->phase / r->up;
+        r->phase %= r->up;
+    }
+
+    // Keep only what later windows still need
+    if (r->pos > 0) {
+        int keep = r->fill - r->pos;
+        if (keep > 0) memmove(r->buffer, r->buffer + r->pos, keep * sizeof(float));
+        r->fill = keep > 0 ? keep : 0;
+        r->pos = keep > 0 ? 0 : -keep;
+    }
+    return count;
+}
+
+int resampler_process(Resampler *r, const float *in, int inCount, float *out) {
+    memcpy(r->buffer + r->fill, in, inCount * sizeof(float));
+    r->fill += inCount;
+    r->inFrames += inCount;
+    return produce(r, out, LLONG_MAX);
+}
+
+int resampler_flush(Resampler *r, float *out) {
+    // taps / 2 zeros complete the windows of the last outputs
+    int half = r->taps / 2;
+    memset(r->buffer + r->fill, 0, half * sizeof(float));
+    r->fill += half;
+    long long total = (r->inFrames * r->up + r->down - 1) / r->down;
+    return produce(r, out, total);
+}
@@ -0,0 +1,60 @@
+// Streaming polyphase sample-rate converter.
+//
+// Converts by the exact ratio outRate / inRate, reduced to up / down: output
+// n sits at input time n * down / up. Each of the up phases has its own
+// precomputed row of Kaiser-windowed sinc taps (cutoff just below the lower
+// of the two Nyquist rates), so every output is one simd_dot_f32 over a
+// contiguous input window. Ratios needing more than RESAMPLER_MAX_PHASES
+// rows interpolate linearly between the two nearest of that many rows
+// instead, which keeps the tables cache-resident for any pair of rates.
+//
+// The filter delay is compensated: feeding N input frames and then calling
+// resampler_flush() yields exactly ceil(N * outRate / inRate) outputs,
+// aligned with the input.
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RESAMPLER_MAX_PHASES 1024
+
+typedef struct {
+    int up, down;             // outRate / inRate in lowest terms
+    int taps;                 // Per phase, a multiple of 8
+    int phases;               // Coefficient rows, up to RESAMPLER_MAX_PHASES
+    float *coeffs;            // (phases + 1) rows of taps
+
+    float *buffer;            // Pending input, oldest first
+    int capacity;
+    int maxBlock;
+    int fill;
+    int pos;                  // Buffer index of the next output's window
+    int phase;                // Fractional input position of the next output, in [0, up)
+    long long inFrames;
+    long long outFrames;
+} Resampler;
+
+// maxBlock is the largest inCount passed to resampler_process().
+// Returns 0 on success, -1 for bad rates or allocation failure.
+int resampler_init(Resampler *r, int inRate, int outRate, int maxBlock);
+void resampler_reset(Resampler *r);
+void resampler_free(Resampler *r);
+
+// Upper bound on the outputs produced by one call with inCount inputs, or by
+// resampler_flush() (inCount 0)
+int resampler_max_output(const Resampler *r, int inCount);
+
+// Consume inCount <= maxBlock samples and write the outputs they complete.
+// Returns the number written.
+int resampler_process(Resampler *r, const float *in, int inCount, float *out);
+
+// Write the outputs still held back by the filter delay at end of stream
+int resampler_flush(Resampler *r, float *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RESAMPLER_H
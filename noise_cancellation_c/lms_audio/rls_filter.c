@@ -0,0 +1,84 @@
+#include "rls_filter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "simd_kernels.h"
+
+int rls_init(RLSFilter *f, int order, double lambda, double delta) {
+    f->order = order;
+    f->lambda = lambda;
+    f->delta = delta;
+    f->weights = (double *)malloc(order * sizeof(double));
+    f->P = (double *)malloc((size_t)order * (order + 1) / 2 * sizeof(double));
+    f->Px = (double *)malloc(order * sizeof(double));
+
+    int bufferStatus = delay_line_init(&f->buffer, order);
+
+    if (!f->weights || bufferStatus != 0 || !f->P || !f->Px) {
+        rls_free(f);
+        return -1;
+    }
+
+    rls_reset(f);
+    return 0;
+}
+
+void rls_reset(RLSFilter *f) {
+    int n = f->order;
+    memset(f->weights, 0, n * sizeof(double));
+    delay_line_reset(&f->buffer);
+
+    // Initialize P as I / delta
+    double *row = f->P;
+    for (int i = 0; i < n; i++) {
+        memset(row, 0, (n - i) * sizeof(double));
+        row[0] = 1.0 / f->delta;
+        row += n - i;
+    }
+}
+
+void rls_free(RLSFilter *f) {
+    free(f->weights);
+    delay_line_free(&f->buffer);
+    free(f->P);
+    free(f->Px);
+    f->weights = f->P = f->Px = NULL;
+}
+
+double rls_step(RLSFilter *f, double x, double d) {
+    int n = f->order;
+    double *Px = f->Px;
+
+    // Push the new sample; the window stays contiguous without shifting
+    delay_line_push(&f->buffer, x);
+    const double *buffer = delay_line_window(&f->buffer);
+
+    // Compute output and a priori error
+    double error = d - simd_dot_f64(f->weights, buffer, n);
+
+    // Px = P * x from the upper triangle: row i contributes its dot product
+    // to Px[i] and, by symmetry, its off-diagonal entries to Px[i+1..]
+    memset(Px, 0, n * sizeof(double));
+    const double *row = f->P;
+    for (int i = 0; i < n; i++) {
+        int len = n - i;
+        Px[i] += simd_dot_f64(row, buffer + i, len);
+        simd_axpy_f64(Px + i + 1, row + 1, buffer[i], len - 1);
+        row += len;
+    }
+
+    // Gain vector K = Px / (lambda + x' P x); applied to the weights directly
+    double den = f->lambda + simd_dot_f64(buffer, Px, n);
+    simd_axpy_f64(f->weights, Px, error / den, n);
+
+    // P = (P - K Px') / lambda, a symmetric rank-1 update done row by row
+    double invLambda = 1.0 / f->lambda;
+    double *prow = f->P;
+    for (int i = 0; i < n; i++) {
+        int len = n - i;
+        simd_axpby_f64(prow, Px + i, invLambda, -Px[i] * invLambda / den, len);
+        prow += len;
+    }
+
+    return error;
+}
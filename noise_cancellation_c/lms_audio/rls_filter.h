@@ -0,0 +1,38 @@
+// Recursive least squares adaptive filter.
+//
+// All state is allocated once in rls_init(); rls_step() does no allocator
+// work. The inverse correlation matrix P is symmetric, so only its upper
+// triangle is stored, packed row by row (row i holds P[i][i..order-1]), and
+// it is updated in place.
+#ifndef RLS_FILTER_H
+#define RLS_FILTER_H
+
+#include "delay_line.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int order;
+    double lambda;     // Forgetting factor
+    double delta;      // P starts as I / delta
+    double *weights;
+    DelayLine buffer;  // Reference samples, oldest first
+    double *P;         // Packed upper triangle, order * (order + 1) / 2 entries
+    double *Px;        // Scratch for P * x
+} RLSFilter;
+
+// Returns 0 on success, -1 if the state could not be allocated
+int rls_init(RLSFilter *f, int order, double lambda, double delta);
+void rls_reset(RLSFilter *f);
+void rls_free(RLSFilter *f);
+
+// Push one reference sample x and noisy sample d; returns the a priori error
+double rls_step(RLSFilter *f, double x, double d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RLS_FILTER_H
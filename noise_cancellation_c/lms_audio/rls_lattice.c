@@ -0,0 +1,112 @@
+#include "rls_lattice.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+int rls_lattice_init(RLSLattice *f, int order, double lambda, double delta) {
+    f->order = order;
+    f->lambda = lambda;
+    f->delta = delta;
+    f->resets = 0;
+    f->F = (double *)malloc(order * sizeof(double));
+    f->Bprev = (double *)malloc(order * sizeof(double));
+    f->bprev = (double *)malloc(order * sizeof(double));
+    f->gammaPrev = (double *)malloc(order * sizeof(double));
+    f->Delta = (double *)malloc(order * sizeof(double));
+    f->rho = (double *)malloc(order * sizeof(double));
+    f->b = (double *)malloc(order * sizeof(double));
+    f->B = (double *)malloc(order * sizeof(double));
+    f->gamma = (double *)malloc((order + 1) * sizeof(double));
+
+    if (!f->F || !f->Bprev || !f->bprev || !f->gammaPrev || !f->Delta || !f->rho ||
+        !f->b || !f->B || !f->gamma) {
+        rls_lattice_free(f);
+        return -1;
+    }
+
+    rls_lattice_reset(f);
+    return 0;
+}
+
+void rls_lattice_reset(RLSLattice *f) {
+    for (int m = 0; m < f->order; m++) {
+        f->F[m] = f->delta;
+        f->Bprev[m] = f->delta;
+        f->bprev[m] = 0.0;
+        f->gammaPrev[m] = 1.0;
+        f->Delta[m] = 0.0;
+        f->rho[m] = 0.0;
+    }
+}
+
+void rls_lattice_free(RLSLattice *f) {
+    free(f->F);
+    free(f->Bprev);
+    free(f->bprev);
+    free(f->gammaPrev);
+    free(f->Delta);
+    free(f->rho);
+    free(f->b);
+    free(f->B);
+    free(f->gamma);
+    f->F = f->Bprev = f->bprev = f->gammaPrev = f->Delta = f->rho = NULL;
+    f->b = f->B = f->gamma = NULL;
+}
+
+double rls_lattice_step(RLSLattice *f, double x, double d) {
+    int order = f->order;
+    double lambda = f->lambda;
+    double *b = f->b, *B = f->B, *gamma = f->gamma;
+
+    // Stage 0: the prediction errors are the input itself
+    double fm = x;
+    f->F[0] = lambda * f->F[0] + x * x;
+    b[0] = x;
+    B[0] = f->F[0];
+    gamma[0] = 1.0;
+    double e = d; // Joint-process a posteriori error
+
+    int ok = 1;
+    for (int m = 0; m < order; m++) {
+        // Joint process: remove the part of d explained by b_m(n)
+        f->rho[m] = lambda * f->rho[m] + b[m] * e / gamma[m];
+        e -= (f->rho[m] / B[m]) * b[m];
+        gamma[m + 1] = gamma[m] - b[m] * b[m] / B[m];
+
+        if (m + 1 < order) {
+            // Lattice stage m+1 from the forward and delayed backward errors
+            double bp = f->bprev[m];
+            f->Delta[m] = lambda * f->Delta[m] + bp * fm / f->gammaPrev[m];
+            double kf = f->Delta[m] / f->Bprev[m];
+            double kb = f->Delta[m] / f->F[m];
+
+            b[m + 1] = bp - kb * fm;
+            B[m + 1] = f->Bprev[m] - f->Delta[m] * kb;
+            f->F[m + 1] = f->F[m] - f->Delta[m] * kf;
+            fm -= kf * bp;
+        }
+
+        // Positive energies and a conversion factor in (0, 1] are what keep
+        // the recursion equivalent to RLS; anything else means it has drifted
+        if (!(B[m] > 0.0) || !(f->F[m] > 0.0) || !(gamma[m + 1] > 0.0) || !(gamma[m + 1] <= 1.0 + 1e-9)) {
+            ok = 0;
+            break;
+        }
+    }
+
+    double error = ok ? e / gamma[order] : 0.0;
+    if (!ok || !isfinite(error)) {
+        rls_lattice_reset(f);
+        f->resets++;
+        return d;
+    }
+
+    // The current errors become the delayed ones for the next sample
+    for (int m = 0; m < order; m++) {
+        f->bprev[m] = b[m];
+        f->Bprev[m] = B[m];
+        f->gammaPrev[m] = gamma[m];
+    }
+
+    return error;
+}
@@ -0,0 +1,48 @@
+// Least-squares lattice (LSL) adaptive filter.
+//
+// Recursive LSL with a posteriori errors and a joint-process (ladder)
+// section: the same least-squares solution as RLS, but each sample costs
+// O(order) instead of O(order^2).
+//
+// Lattice recursions lose positive definiteness on long runs. Every sample is
+// checked (finite errors, positive energies, conversion factor in (0, 1]);
+// on failure the filter re-initializes itself, passes that sample through
+// and counts the event in `resets`.
+#ifndef RLS_LATTICE_H
+#define RLS_LATTICE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int order;
+    double lambda;     // Forgetting factor
+    double delta;      // Initial prediction error energy
+    long resets;       // Number of automatic re-initializations
+
+    // Per stage, m = 0..order-1
+    double *F;         // Forward prediction error energy F_m(n)
+    double *Bprev;     // Backward prediction error energy B_m(n-1)
+    double *bprev;     // Backward a posteriori error b_m(n-1)
+    double *gammaPrev; // Conversion factor gamma_m(n-1)
+    double *Delta;     // Forward/backward cross-correlation
+    double *rho;       // Joint-process cross-correlation
+    double *b;         // Scratch: b_m(n)
+    double *B;         // Scratch: B_m(n)
+    double *gamma;     // Scratch: gamma_m(n), order + 1 entries
+} RLSLattice;
+
+// Returns 0 on success, -1 if the state could not be allocated
+int rls_lattice_init(RLSLattice *f, int order, double lambda, double delta);
+void rls_lattice_reset(RLSLattice *f);
+void rls_lattice_free(RLSLattice *f);
+
+// Push one reference sample x and noisy sample d; returns the a priori error
+double rls_lattice_step(RLSLattice *f, double x, double d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RLS_LATTICE_H
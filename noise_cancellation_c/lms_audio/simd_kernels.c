@@ -0,0 +1,1284 @@
+#include "simd_kernels.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// GCC/Clang compile each version for its own instruction set; MSVC accepts
+// the intrinsics without flags
+#if defined(__GNUC__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
+
+typedef float (*DotFn)(const float *, const float *, int);
+typedef float (*SqdiffFn)(const float *, const float *, int);
+typedef void (*AxpyFn)(float *, const float *, float, int);
+typedef float (*LmsStepFn)(float *, const float *, float, const float *, int);
+typedef void (*ClmsStepFn)(float *, const float *, float, float, const float *, int, float *, float *);
+typedef void (*CscaleFn)(float *, const float *, int);
+typedef double (*DotF64Fn)(const double *, const double *, int);
+typedef void (*AxpyF64Fn)(double *, const double *, double, int);
+typedef void (*AxpbyF64Fn)(double *, const double *, double, double, int);
+typedef long long (*LmsStepQ15Fn)(short *, const short *, short, const short *, int);
+typedef void (*PeakI16Fn)(const short *, int, short *, short *, long long *);
+typedef long long (*DotI16Fn)(const short *, const short *, int);
+typedef void (*MixI16Fn)(const short *, int, float *, float, int);
+typedef void (*MixF32Fn)(const float *, int, float *, float, int);
+typedef void (*F32ToI16Fn)(const float *, short *, float, int);
+
+typedef struct {
+    const char *name;
+    DotFn dot;
+    SqdiffFn sqdiff;
+    AxpyFn axpy;
+    LmsStepFn lmsStep;
+    ClmsStepFn clmsStep;
+    CscaleFn cscale;
+    DotF64Fn dotF64;
+    AxpyF64Fn axpyF64;
+    AxpbyF64Fn axpbyF64;
+    LmsStepQ15Fn lmsStepQ15;
+    PeakI16Fn peakI16;
+    DotI16Fn dotI16;
+    MixI16Fn mixI16;
+    MixF32Fn mixF32;
+    F32ToI16Fn f32ToI16;
+} KernelSet;
+
+// ---- Scalar ----
+
+static float dot_scalar(const float *a, const float *b, int n) {
+    float acc = 0.0f;
+    for (int i = 0; i < n; i++) {
+        acc += a[i] * b[i];
+    }
+    return acc;
+}
+
+static float sqdiff_scalar(const float *a, const float *b, int n) {
+    float acc = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float d = a[i] - b[i];
+        acc += d * d;
+    }
+    return acc;
+}
+
+static void axpy_scalar(float *y, const float *x, float a, int n) {
+    for (int i = 0; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+static float lms_step_scalar(float *w, const float *xPrev, float g, const float *x, int n) {
+    float acc = 0.0f;
+    for (int i = 0; i < n; i++) {
+        w[i] += g * xPrev[i];
+        acc += w[i] * x[i];
+    }
+    return acc;
+}
+
+// Complex taps i..n of the complex LMS step, added to *yr and *yi
+static void clms_step_tail(float *w, const float *xPrev, float gr, float gi, const float *x, int i, int n,
+                           float *yr, float *yi) {
+    float accR = 0.0f, accI = 0.0f;
+    for (; i < n; i++) {
+        float pr = xPrev[2 * i], pi = xPrev[2 * i + 1];
+        float wr = w[2 * i] + gr * pr - gi * pi;
+        float wi = w[2 * i + 1] + gr * pi + gi * pr;
+        w[2 * i] = wr;
+        w[2 * i + 1] = wi;
+        accR += wr * x[2 * i] + wi * x[2 * i + 1];
+        accI += wr * x[2 * i + 1] - wi * x[2 * i];
+    }
+    *yr += accR;
+    *yi += accI;
+}
+
+static void clms_step_scalar(float *w, const float *xPrev, float gr, float gi, const float *x, int n, float *yr,
+                             float *yi) {
+    *yr = *yi = 0.0f;
+    clms_step_tail(w, xPrev, gr, gi, x, 0, n, yr, yi);
+}
+
+static void cscale_scalar(float *x, const float *g, int n) {
+    for (int i = 0; i < n; i++) {
+        x[2 * i] *= g[i];
+        x[2 * i + 1] *= g[i];
+    }
+}
+
+static double dot_f64_scalar(const double *a, const double *b, int n) {
+    double acc = 0.0;
+    for (int i = 0; i < n; i++) {
+        acc += a[i] * b[i];
+    }
+    return acc;
+}
+
+static void axpy_f64_scalar(double *y, const double *x, double a, int n) {
+    for (int i = 0; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+static void axpby_f64_scalar(double *y, const double *x, double a, double b, int n) {
+    for (int i = 0; i < n; i++) {
+        y[i] = a * y[i] + b * x[i];
+    }
+}
+
+// One Q15 weight update, exactly as the vector versions do it: rounded
+// product (pmulhrsw), saturating add (paddsw), then clamp to -32767 so
+// pmaddwd can never see -32768 * -32768
+static long long lms_step_q15_tail(short *w, const short *xPrev, short g, const short *x, int i, int n) {
+    long long acc = 0;
+    for (; i < n; i++) {
+        int v = w[i] + (short)(((int)g * xPrev[i] + 0x4000) >> 15);
+        if (v > 32767) v = 32767;
+        if (v < -32767) v = -32767;
+        w[i] = (short)v;
+        acc += (int)w[i] * x[i];
+    }
+    return acc;
+}
+
+// A pmaddwd lane (at most 2 * 32767 * 32768 < 2^31) cannot be summed in 32
+// bits, so the vector versions split each one into its signed high and
+// unsigned low 16 bits, sum those separately in 32-bit lanes and combine
+// them in 64 bits only at the end: two cheap ops per vector instead of a
+// full widening.
+#define Q15_SPLIT_VECTORS 32768   // Vectors per split sum before it could overflow
+
+static long long lms_step_q15_scalar(short *w, const short *xPrev, short g, const short *x, int n) {
+    return lms_step_q15_tail(w, xPrev, g, x, 0, n);
+}
+
+static void peak_i16_tail(const short *x, int i, int n, int *lo, int *hi, long long *sum) {
+    for (; i < n; i++) {
+        if (x[i] < *lo) *lo = x[i];
+        if (x[i] > *hi) *hi = x[i];
+        *sum += (int)x[i] * x[i];
+    }
+}
+
+static void peak_i16_scalar(const short *x, int n, short *min, short *max, long long *sumSquares) {
+    int lo = 32767, hi = -32768;
+    long long sum = 0;
+    peak_i16_tail(x, 0, n, &lo, &hi, &sum);
+    *min = (short)lo;
+    *max = (short)hi;
+    *sumSquares = sum;
+}
+
+static long long dot_i16_scalar(const short *a, const short *b, int n) {
+    long long sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += (int)a[i] * b[i];
+    }
+    return sum;
+}
+
+// The conversion kernels vectorise mono and stereo, the common cases, and
+// hand other channel counts and the tails to these. Sums run in channel
+// order so every level gives the same bits.
+static void mix_i16_tail(const short *x, int channels, float *y, float scale, int i, int n) {
+    for (; i < n; i++) {
+        int sum = 0;
+        for (int c = 0; c < channels; c++) sum += x[(size_t)i * channels + c];
+        y[i] = (float)sum * scale;
+    }
+}
+
+static void mix_f32_tail(const float *x, int channels, float *y, float scale, int i, int n) {
+    for (; i < n; i++) {
+        float sum = x[(size_t)i * channels];
+        for (int c = 1; c < channels; c++) sum += x[(size_t)i * channels + c];
+        y[i] = sum * scale;
+    }
+}
+
+static void f32_to_i16_tail(const float *x, short *y, float scale, int i, int n) {
+    for (; i < n; i++) {
+        float v = x[i] * scale;
+        if (v > 32767.0f) v = 32767.0f;
+        if (v < -32768.0f) v = -32768.0f;
+        y[i] = (short)(v < 0 ? v - 0.5f : v + 0.5f);
+    }
+}
+
+static void mix_i16_scalar(const short *x, int channels, float *y, float scale, int n) {
+    mix_i16_tail(x, channels, y, scale, 0, n);
+}
+
+static void mix_f32_scalar(const float *x, int channels, float *y, float scale, int n) {
+    mix_f32_tail(x, channels, y, scale, 0, n);
+}
+
+static void f32_to_i16_scalar(const float *x, short *y, float scale, int n) {
+    f32_to_i16_tail(x, y, scale, 0, n);
+}
+
+#ifdef SIMD_X86
+
+// ---- SSE2 ----
+
+SIMD_TARGET("sse2")
+static float hsum_sse2(__m128 v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+SIMD_TARGET("sse2")
+static float dot_sse2(const float *a, const float *b, int n) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float acc = hsum_sse2(_mm_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        acc += a[i] * b[i];
+    }
+    return acc;
+}
+
+SIMD_TARGET("sse2")
+static float sqdiff_sse2(const float *a, const float *b, int n) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+    }
+    float acc = hsum_sse2(_mm_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        float d = a[i] - b[i];
+        acc += d * d;
+    }
+    return acc;
+}
+
+SIMD_TARGET("sse2")
+static void axpy_sse2(float *y, const float *x, float a, int n) {
+    __m128 va = _mm_set1_ps(a);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+    }
+    for (; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+SIMD_TARGET("sse2")
+static float lms_step_sse2(float *w, const float *xPrev, float g, const float *x, int n) {
+    __m128 vg = _mm_set1_ps(g);
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 w0 = _mm_add_ps(_mm_loadu_ps(w + i), _mm_mul_ps(vg, _mm_loadu_ps(xPrev + i)));
+        __m128 w1 = _mm_add_ps(_mm_loadu_ps(w + i + 4), _mm_mul_ps(vg, _mm_loadu_ps(xPrev + i + 4)));
+        _mm_storeu_ps(w + i, w0);
+        _mm_storeu_ps(w + i + 4, w1);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(w0, _mm_loadu_ps(x + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(w1, _mm_loadu_ps(x + i + 4)));
+    }
+    float acc = hsum_sse2(_mm_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        w[i] += g * xPrev[i];
+        acc += w[i] * x[i];
+    }
+    return acc;
+}
+
+// Two complex taps per vector. With the [re, im] pairs swapped, w * x gives
+// the real part of conj(w) * x in both lanes of a pair and w * swap(x) the
+// imaginary part with the sign flipped in the odd lane; the update is the
+// same trick with g's imaginary part signed [-gi, gi].
+SIMD_TARGET("sse2")
+static void clms_step_sse2(float *w, const float *xPrev, float gr, float gi, const float *x, int n, float *yr,
+                           float *yi) {
+    __m128 vgr = _mm_set1_ps(gr), vgi = _mm_setr_ps(-gi, gi, -gi, gi);
+    __m128 accR = _mm_setzero_ps(), accI = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128 p = _mm_loadu_ps(xPrev + 2 * i), v = _mm_loadu_ps(x + 2 * i);
+        __m128 pSwap = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 wv = _mm_add_ps(_mm_loadu_ps(w + 2 * i), _mm_add_ps(_mm_mul_ps(vgr, p), _mm_mul_ps(vgi, pSwap)));
+        _mm_storeu_ps(w + 2 * i, wv);
+        accR = _mm_add_ps(accR, _mm_mul_ps(wv, v));
+        accI = _mm_add_ps(accI, _mm_mul_ps(wv, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1))));
+    }
+    *yr = hsum_sse2(accR);
+    *yi = hsum_sse2(_mm_mul_ps(accI, _mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f)));
+    clms_step_tail(w, xPrev, gr, gi, x, i, n, yr, yi);
+}
+
+SIMD_TARGET("sse2")
+static void cscale_sse2(float *x, const float *g, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(g + i);
+        _mm_storeu_ps(x + 2 * i, _mm_mul_ps(_mm_loadu_ps(x + 2 * i), _mm_unpacklo_ps(v, v)));
+        _mm_storeu_ps(x + 2 * i + 4, _mm_mul_ps(_mm_loadu_ps(x + 2 * i + 4), _mm_unpackhi_ps(v, v)));
+    }
+    for (; i < n; i++) {
+        x[2 * i] *= g[i];
+        x[2 * i + 1] *= g[i];
+    }
+}
+
+// SSE2 has no pmulhrsw; rebuild it from the 32-bit products. packs only
+// differs from pmulhrsw for -32768 * -32768, which g never is.
+SIMD_TARGET("sse2")
+static __m128i mulhrs_sse2(__m128i a, __m128i b) {
+    __m128i lo = _mm_mullo_epi16(a, b), hi = _mm_mulhi_epi16(a, b);
+    __m128i round = _mm_set1_epi32(0x4000);
+    __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+    __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+    return _mm_packs_epi32(p0, p1);
+}
+
+SIMD_TARGET("sse2")
+static long long lms_step_q15_sse2(short *w, const short *xPrev, short g, const short *x, int n) {
+    __m128i vg = _mm_set1_epi16(g), floor = _mm_set1_epi16(-32767);
+    __m128i lowMask = _mm_set1_epi32(0xFFFF);
+    long long total = 0;
+    int i = 0;
+    while (i + 8 <= n) {
+        int end = n - i > 8 * Q15_SPLIT_VECTORS ? i + 8 * Q15_SPLIT_VECTORS : n;
+        __m128i hi = _mm_setzero_si128(), lo = _mm_setzero_si128();
+        for (; i + 8 <= end; i += 8) {
+            __m128i wv = _mm_adds_epi16(_mm_loadu_si128((const __m128i *)(w + i)),
+                                        mulhrs_sse2(vg, _mm_loadu_si128((const __m128i *)(xPrev + i))));
+            wv = _mm_max_epi16(wv, floor);
+            _mm_storeu_si128((__m128i *)(w + i), wv);
+            __m128i p = _mm_madd_epi16(wv, _mm_loadu_si128((const __m128i *)(x + i)));
+            hi = _mm_add_epi32(hi, _mm_srai_epi32(p, 16));
+            lo = _mm_add_epi32(lo, _mm_and_si128(p, lowMask));
+        }
+        int hiLanes[4], loLanes[4];
+        _mm_storeu_si128((__m128i *)hiLanes, hi);
+        _mm_storeu_si128((__m128i *)loLanes, lo);
+        for (int k = 0; k < 4; k++) total += (long long)hiLanes[k] * 65536 + (unsigned)loLanes[k];
+    }
+    return total + lms_step_q15_tail(w, xPrev, g, x, i, n);
+}
+
+// x * x through pmaddwd: each lane is at most 2 * 32768^2 = 2^31, so it is
+// split as unsigned (logical shift) rather than signed like the LMS sums
+SIMD_TARGET("sse2")
+static void peak_i16_sse2(const short *x, int n, short *min, short *max, long long *sumSquares) {
+    __m128i vmin = _mm_set1_epi16(32767), vmax = _mm_set1_epi16(-32768);
+    __m128i lowMask = _mm_set1_epi32(0xFFFF);
+    long long total = 0;
+    int i = 0;
+    while (i + 8 <= n) {
+        int end = n - i > 8 * Q15_SPLIT_VECTORS ? i + 8 * Q15_SPLIT_VECTORS : n;
+        __m128i hi = _mm_setzero_si128(), lo = _mm_setzero_si128();
+        for (; i + 8 <= end; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(x + i));
+            vmin = _mm_min_epi16(vmin, v);
+            vmax = _mm_max_epi16(vmax, v);
+            __m128i p = _mm_madd_epi16(v, v);
+            hi = _mm_add_epi32(hi, _mm_srli_epi32(p, 16));
+            lo = _mm_add_epi32(lo, _mm_and_si128(p, lowMask));
+        }
+        unsigned hiLanes[4], loLanes[4];
+        _mm_storeu_si128((__m128i *)hiLanes, hi);
+        _mm_storeu_si128((__m128i *)loLanes, lo);
+        for (int k = 0; k < 4; k++) total += (long long)hiLanes[k] * 65536 + loLanes[k];
+    }
+    short minLanes[8], maxLanes[8];
+    _mm_storeu_si128((__m128i *)minLanes, vmin);
+    _mm_storeu_si128((__m128i *)maxLanes, vmax);
+    int lo = 32767, hi = -32768;
+    for (int k = 0; k < 8; k++) {
+        if (minLanes[k] < lo) lo = minLanes[k];
+        if (maxLanes[k] > hi) hi = maxLanes[k];
+    }
+    peak_i16_tail(x, i, n, &lo, &hi, &total);
+    *min = (short)lo;
+    *max = (short)hi;
+    *sumSquares = total;
+}
+
+// Here both inputs may be -32768, and a lane holding two such products
+// (2^31) wraps to INT_MIN, a sum no other pair can reach. Those lanes are
+// counted alongside the split sums and put back as 2^32 each.
+SIMD_TARGET("sse2")
+static long long dot_i16_sse2(const short *a, const short *b, int n) {
+    __m128i lowMask = _mm_set1_epi32(0xFFFF), wrapped = _mm_set1_epi32((int)0x80000000u);
+    long long total = 0;
+    int i = 0;
+    while (i + 8 <= n) {
+        int end = n - i > 8 * Q15_SPLIT_VECTORS ? i + 8 * Q15_SPLIT_VECTORS : n;
+        __m128i hi = _mm_setzero_si128(), lo = _mm_setzero_si128(), wraps = _mm_setzero_si128();
+        for (; i + 8 <= end; i += 8) {
+            __m128i p = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)),
+                                       _mm_loadu_si128((const __m128i *)(b + i)));
+            hi = _mm_add_epi32(hi, _mm_srai_epi32(p, 16));
+            lo = _mm_add_epi32(lo, _mm_and_si128(p, lowMask));
+            wraps = _mm_sub_epi32(wraps, _mm_cmpeq_epi32(p, wrapped));
+        }
+        int hiLanes[4], wrapLanes[4];
+        unsigned loLanes[4];
+        _mm_storeu_si128((__m128i *)hiLanes, hi);
+        _mm_storeu_si128((__m128i *)loLanes, lo);
+        _mm_storeu_si128((__m128i *)wrapLanes, wraps);
+        for (int k = 0; k < 4; k++) {
+            total += (long long)hiLanes[k] * 65536 + loLanes[k] + ((long long)wrapLanes[k] << 32);
+        }
+    }
+    for (; i < n; i++) total += (int)a[i] * b[i];
+    return total;
+}
+
+// Stereo frames sum exactly in 32 bits through pmaddwd against ones
+SIMD_TARGET("sse2")
+static void mix_i16_sse2(const short *x, int channels, float *y, float scale, int n) {
+    __m128 vs = _mm_set1_ps(scale);
+    int i = 0;
+    if (channels == 1) {
+        for (; i + 8 <= n; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(x + i));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(y + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vs));
+            _mm_storeu_ps(y + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vs));
+        }
+    } else if (channels == 2) {
+        __m128i ones = _mm_set1_epi16(1);
+        for (; i + 4 <= n; i += 4) {
+            __m128i sum = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(x + 2 * i)), ones);
+            _mm_storeu_ps(y + i, _mm_mul_ps(_mm_cvtepi32_ps(sum), vs));
+        }
+    }
+    mix_i16_tail(x, channels, y, scale, i, n);
+}
+
+SIMD_TARGET("sse2")
+static void mix_f32_sse2(const float *x, int channels, float *y, float scale, int n) {
+    __m128 vs = _mm_set1_ps(scale);
+    int i = 0;
+    if (channels == 1) {
+        for (; i + 4 <= n; i += 4) _mm_storeu_ps(y + i, _mm_mul_ps(_mm_loadu_ps(x + i), vs));
+    } else if (channels == 2) {
+        for (; i + 4 <= n; i += 4) {
+            __m128 a = _mm_loadu_ps(x + 2 * i), b = _mm_loadu_ps(x + 2 * i + 4);
+            __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(y + i, _mm_mul_ps(_mm_add_ps(left, right), vs));
+        }
+    }
+    mix_f32_tail(x, channels, y, scale, i, n);
+}
+
+// Clamp, add +-0.5 and truncate: the same steps as the scalar version
+SIMD_TARGET("sse2")
+static void f32_to_i16_sse2(const float *x, short *y, float scale, int n) {
+    __m128 vs = _mm_set1_ps(scale), lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+    __m128 sign = _mm_set1_ps(-0.0f), half = _mm_set1_ps(0.5f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(x + i), vs), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(x + i + 4), vs), lo), hi);
+        a = _mm_add_ps(a, _mm_or_ps(_mm_and_ps(a, sign), half));
+        b = _mm_add_ps(b, _mm_or_ps(_mm_and_ps(b, sign), half));
+        _mm_storeu_si128((__m128i *)(y + i), _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+    }
+    f32_to_i16_tail(x, y, scale, i, n);
+}
+
+SIMD_TARGET("sse2")
+static double dot_f64_sse2(const double *a, const double *b, int n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+    double acc = _mm_cvtsd_f64(_mm_add_sd(acc0, _mm_unpackhi_pd(acc0, acc0)));
+    for (; i < n; i++) {
+        acc += a[i] * b[i];
+    }
+    return acc;
+}
+
+SIMD_TARGET("sse2")
+static void axpy_f64_sse2(double *y, const double *x, double a, int n) {
+    __m128d va = _mm_set1_pd(a);
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i))));
+    }
+    for (; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+SIMD_TARGET("sse2")
+static void axpby_f64_sse2(double *y, const double *x, double a, double b, int n) {
+    __m128d va = _mm_set1_pd(a), vb = _mm_set1_pd(b);
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_add_pd(_mm_mul_pd(va, _mm_loadu_pd(y + i)), _mm_mul_pd(vb, _mm_loadu_pd(x + i)));
+        _mm_storeu_pd(y + i, v);
+    }
+    for (; i < n; i++) {
+        y[i] = a * y[i] + b * x[i];
+    }
+}
+
+// ---- AVX2 + FMA ----
+
+SIMD_TARGET("avx2,fma")
+static float hsum_avx(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+    return _mm_cvtss_f32(lo);
+}
+
+SIMD_TARGET("avx2,fma")
+static float dot_avx2(const float *a, const float *b, int n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    if (i + 8 <= n) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        i += 8;
+    }
+    float acc = hsum_avx(_mm256_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        acc += a[i] * b[i];
+    }
+    return acc;
+}
+
+SIMD_TARGET("avx2,fma")
+static float sqdiff_avx2(const float *a, const float *b, int n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    if (i + 8 <= n) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        i += 8;
+    }
+    float acc = hsum_avx(_mm256_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        float d = a[i] - b[i];
+        acc += d * d;
+    }
+    return acc;
+}
+
+SIMD_TARGET("avx2,fma")
+static void axpy_avx2(float *y, const float *x, float a, int n) {
+    __m256 va = _mm256_set1_ps(a);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+    for (; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+SIMD_TARGET("avx2,fma")
+static float lms_step_avx2(float *w, const float *xPrev, float g, const float *x, int n) {
+    __m256 vg = _mm256_set1_ps(g);
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 w0 = _mm256_fmadd_ps(vg, _mm256_loadu_ps(xPrev + i), _mm256_loadu_ps(w + i));
+        __m256 w1 = _mm256_fmadd_ps(vg, _mm256_loadu_ps(xPrev + i + 8), _mm256_loadu_ps(w + i + 8));
+        _mm256_storeu_ps(w + i, w0);
+        _mm256_storeu_ps(w + i + 8, w1);
+        acc0 = _mm256_fmadd_ps(w0, _mm256_loadu_ps(x + i), acc0);
+        acc1 = _mm256_fmadd_ps(w1, _mm256_loadu_ps(x + i + 8), acc1);
+    }
+    float acc = hsum_avx(_mm256_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        w[i] += g * xPrev[i];
+        acc += w[i] * x[i];
+    }
+    return acc;
+}
+
+SIMD_TARGET("avx2,fma")
+static void clms_step_avx2(float *w, const float *xPrev, float gr, float gi, const float *x, int n, float *yr,
+                           float *yi) {
+    __m256 vgr = _mm256_set1_ps(gr), vgi = _mm256_setr_ps(-gi, gi, -gi, gi, -gi, gi, -gi, gi);
+    __m256 accR = _mm256_setzero_ps(), accI = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256 p = _mm256_loadu_ps(xPrev + 2 * i), v = _mm256_loadu_ps(x + 2 * i);
+        __m256 wv = _mm256_fmadd_ps(vgr, p, _mm256_loadu_ps(w + 2 * i));
+        wv = _mm256_fmadd_ps(vgi, _mm256_permute_ps(p, 0xB1), wv);
+        _mm256_storeu_ps(w + 2 * i, wv);
+        accR = _mm256_fmadd_ps(wv, v, accR);
+        accI = _mm256_fmadd_ps(wv, _mm256_permute_ps(v, 0xB1), accI);
+    }
+    *yr = hsum_avx(accR);
+    *yi = hsum_avx(_mm256_mul_ps(accI, _mm256_setr_ps(1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f)));
+    clms_step_tail(w, xPrev, gr, gi, x, i, n, yr, yi);
+}
+
+// The in-lane unpacks give the pairs of gains 0, 1, 4, 5 and 2, 3, 6, 7;
+// the lane permutes put them back in order
+SIMD_TARGET("avx2,fma")
+static void cscale_avx2(float *x, const float *g, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(g + i);
+        __m256 lo = _mm256_unpacklo_ps(v, v), hi = _mm256_unpackhi_ps(v, v);
+        _mm256_storeu_ps(x + 2 * i, _mm256_mul_ps(_mm256_loadu_ps(x + 2 * i), _mm256_permute2f128_ps(lo, hi, 0x20)));
+        _mm256_storeu_ps(x + 2 * i + 8,
+                         _mm256_mul_ps(_mm256_loadu_ps(x + 2 * i + 8), _mm256_permute2f128_ps(lo, hi, 0x31)));
+    }
+    for (; i < n; i++) {
+        x[2 * i] *= g[i];
+        x[2 * i + 1] *= g[i];
+    }
+}
+
+// 16 taps per vector, twice the float kernels
+SIMD_TARGET("avx2")
+static long long lms_step_q15_avx2(short *w, const short *xPrev, short g, const short *x, int n) {
+    __m256i vg = _mm256_set1_epi16(g), floor = _mm256_set1_epi16(-32767);
+    __m256i lowMask = _mm256_set1_epi32(0xFFFF);
+    long long total = 0;
+    int i = 0;
+    while (i + 16 <= n) {
+        int end = n - i > 16 * Q15_SPLIT_VECTORS ? i + 16 * Q15_SPLIT_VECTORS : n;
+        __m256i hi = _mm256_setzero_si256(), lo = _mm256_setzero_si256();
+        for (; i + 16 <= end; i += 16) {
+            __m256i wv = _mm256_adds_epi16(_mm256_loadu_si256((const __m256i *)(w + i)),
+                                           _mm256_mulhrs_epi16(vg, _mm256_loadu_si256((const __m256i *)(xPrev + i))));
+            wv = _mm256_max_epi16(wv, floor);
+            _mm256_storeu_si256((__m256i *)(w + i), wv);
+            __m256i p = _mm256_madd_epi16(wv, _mm256_loadu_si256((const __m256i *)(x + i)));
+            hi = _mm256_add_epi32(hi, _mm256_srai_epi32(p, 16));
+            lo = _mm256_add_epi32(lo, _mm256_and_si256(p, lowMask));
+        }
+        int hiLanes[8], loLanes[8];
+        _mm256_storeu_si256((__m256i *)hiLanes, hi);
+        _mm256_storeu_si256((__m256i *)loLanes, lo);
+        for (int k = 0; k < 8; k++) total += (long long)hiLanes[k] * 65536 + (unsigned)loLanes[k];
+    }
+    return total + lms_step_q15_tail(w, xPrev, g, x, i, n);
+}
+
+SIMD_TARGET("avx2")
+static void peak_i16_avx2(const short *x, int n, short *min, short *max, long long *sumSquares) {
+    __m256i vmin = _mm256_set1_epi16(32767), vmax = _mm256_set1_epi16(-32768);
+    __m256i lowMask = _mm256_set1_epi32(0xFFFF);
+    long long total = 0;
+    int i = 0;
+    while (i + 16 <= n) {
+        int end = n - i > 16 * Q15_SPLIT_VECTORS ? i + 16 * Q15_SPLIT_VECTORS : n;
+        __m256i hi = _mm256_setzero_si256(), lo = _mm256_setzero_si256();
+        for (; i + 16 <= end; i += 16) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(x + i));
+            vmin = _mm256_min_epi16(vmin, v);
+            vmax = _mm256_max_epi16(vmax, v);
+            __m256i p = _mm256_madd_epi16(v, v);
+            hi = _mm256_add_epi32(hi, _mm256_srli_epi32(p, 16));
+            lo = _mm256_add_epi32(lo, _mm256_and_si256(p, lowMask));
+        }
+        unsigned hiLanes[8], loLanes[8];
+        _mm256_storeu_si256((__m256i *)hiLanes, hi);
+        _mm256_storeu_si256((__m256i *)loLanes, lo);
+        for (int k = 0; k < 8; k++) total += (long long)hiLanes[k] * 65536 + loLanes[k];
+    }
+    short minLanes[16], maxLanes[16];
+    _mm256_storeu_si256((__m256i *)minLanes, vmin);
+    _mm256_storeu_si256((__m256i *)maxLanes, vmax);
+    int lo = 32767, hi = -32768;
+    for (int k = 0; k < 16; k++) {
+        if (minLanes[k] < lo) lo = minLanes[k];
+        if (maxLanes[k] > hi) hi = maxLanes[k];
+    }
+    peak_i16_tail(x, i, n, &lo, &hi, &total);
+    *min = (short)lo;
+    *max = (short)hi;
+    *sumSquares = total;
+}
+
+SIMD_TARGET("avx2")
+static long long dot_i16_avx2(const short *a, const short *b, int n) {
+    __m256i lowMask = _mm256_set1_epi32(0xFFFF), wrapped = _mm256_set1_epi32((int)0x80000000u);
+    long long total = 0;
+    int i = 0;
+    while (i + 16 <= n) {
+        int end = n - i > 16 * Q15_SPLIT_VECTORS ? i + 16 * Q15_SPLIT_VECTORS : n;
+        __m256i hi = _mm256_setzero_si256(), lo = _mm256_setzero_si256(), wraps = _mm256_setzero_si256();
+        for (; i + 16 <= end; i += 16) {
+            __m256i p = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                          _mm256_loadu_si256((const __m256i *)(b + i)));
+            hi = _mm256_add_epi32(hi, _mm256_srai_epi32(p, 16));
+            lo = _mm256_add_epi32(lo, _mm256_and_si256(p, lowMask));
+            wraps = _mm256_sub_epi32(wraps, _mm256_cmpeq_epi32(p, wrapped));
+        }
+        int hiLanes[8], wrapLanes[8];
+        unsigned loLanes[8];
+        _mm256_storeu_si256((__m256i *)hiLanes, hi);
+        _mm256_storeu_si256((__m256i *)loLanes, lo);
+        _mm256_storeu_si256((__m256i *)wrapLanes, wraps);
+        for (int k = 0; k < 8; k++) {
+            total += (long long)hiLanes[k] * 65536 + loLanes[k] + ((long long)wrapLanes[k] << 32);
+        }
+    }
+    for (; i < n; i++) total += (int)a[i] * b[i];
+    return total;
+}
+
+SIMD_TARGET("avx2")
+static void mix_i16_avx2(const short *x, int channels, float *y, float scale, int n) {
+    __m256 vs = _mm256_set1_ps(scale);
+    int i = 0;
+    if (channels == 1) {
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(x + i)));
+            _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), vs));
+        }
+    } else if (channels == 2) {
+        __m256i ones = _mm256_set1_epi16(1);
+        for (; i + 8 <= n; i += 8) {
+            __m256i sum = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(x + 2 * i)), ones);
+            _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_cvtepi32_ps(sum), vs));
+        }
+    }
+    mix_i16_tail(x, channels, y, scale, i, n);
+}
+
+SIMD_TARGET("avx2")
+static void mix_f32_avx2(const float *x, int channels, float *y, float scale, int n) {
+    __m256 vs = _mm256_set1_ps(scale);
+    int i = 0;
+    if (channels == 1) {
+        for (; i + 8 <= n; i += 8) _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), vs));
+    } else if (channels == 2) {
+        for (; i + 8 <= n; i += 8) {
+            __m256 a = _mm256_loadu_ps(x + 2 * i), b = _mm256_loadu_ps(x + 2 * i + 8);
+            __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            // The shuffles work per 128-bit lane; put the frames back in order
+            __m256 sum = _mm256_add_ps(left, right);
+            sum = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0)));
+            _mm256_storeu_ps(y + i, _mm256_mul_ps(sum, vs));
+        }
+    }
+    mix_f32_tail(x, channels, y, scale, i, n);
+}
+
+SIMD_TARGET("avx2")
+static void f32_to_i16_avx2(const float *x, short *y, float scale, int n) {
+    __m256 vs = _mm256_set1_ps(scale), lo = _mm256_set1_ps(-32768.0f), hi = _mm256_set1_ps(32767.0f);
+    __m256 sign = _mm256_set1_ps(-0.0f), half = _mm256_set1_ps(0.5f);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(x + i), vs), lo), hi);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(x + i + 8), vs), lo), hi);
+        a = _mm256_add_ps(a, _mm256_or_ps(_mm256_and_ps(a, sign), half));
+        b = _mm256_add_ps(b, _mm256_or_ps(_mm256_and_ps(b, sign), half));
+        __m256i packed = _mm256_packs_epi32(_mm256_cvttps_epi32(a), _mm256_cvttps_epi32(b));
+        _mm256_storeu_si256((__m256i *)(y + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    f32_to_i16_tail(x, y, scale, i, n);
+}
+
+SIMD_TARGET("avx2,fma")
+static double dot_f64_avx2(const double *a, const double *b, int n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    __m128d lo = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    double acc = _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    for (; i < n; i++) {
+        acc += a[i] * b[i];
+    }
+    return acc;
+}
+
+SIMD_TARGET("avx2,fma")
+static void axpy_f64_avx2(double *y, const double *x, double a, int n) {
+    __m256d va = _mm256_set1_pd(a);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    for (; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+SIMD_TARGET("avx2,fma")
+static void axpby_f64_avx2(double *y, const double *x, double a, double b, int n) {
+    __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_fmadd_pd(vb, _mm256_loadu_pd(x + i), _mm256_mul_pd(va, _mm256_loadu_pd(y + i)));
+        _mm256_storeu_pd(y + i, v);
+    }
+    for (; i < n; i++) {
+        y[i] = a * y[i] + b * x[i];
+    }
+}
+
+// ---- AVX-512 ----
+
+SIMD_TARGET("avx512f")
+static float dot_avx512(const float *a, const float *b, int n) {
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    for (; i < n; i += 16) {
+        __mmask16 m = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i), acc0);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+SIMD_TARGET("avx512f")
+static float sqdiff_avx512(const float *a, const float *b, int n) {
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        __m512 d1 = _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+        acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm512_fmadd_ps(d1, d1, acc1);
+    }
+    for (; i < n; i += 16) {
+        __mmask16 m = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __m512 d0 = _mm512_sub_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i));
+        acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+SIMD_TARGET("avx512f")
+static void axpy_avx512(float *y, const float *x, float a, int n) {
+    __m512 va = _mm512_set1_ps(a);
+    for (int i = 0; i < n; i += 16) {
+        __mmask16 m = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __m512 v = _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, x + i), _mm512_maskz_loadu_ps(m, y + i));
+        _mm512_mask_storeu_ps(y + i, m, v);
+    }
+}
+
+SIMD_TARGET("avx512f")
+static float lms_step_avx512(float *w, const float *xPrev, float g, const float *x, int n) {
+    __m512 vg = _mm512_set1_ps(g);
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512 w0 = _mm512_fmadd_ps(vg, _mm512_loadu_ps(xPrev + i), _mm512_loadu_ps(w + i));
+        __m512 w1 = _mm512_fmadd_ps(vg, _mm512_loadu_ps(xPrev + i + 16), _mm512_loadu_ps(w + i + 16));
+        _mm512_storeu_ps(w + i, w0);
+        _mm512_storeu_ps(w + i + 16, w1);
+        acc0 = _mm512_fmadd_ps(w0, _mm512_loadu_ps(x + i), acc0);
+        acc1 = _mm512_fmadd_ps(w1, _mm512_loadu_ps(x + i + 16), acc1);
+    }
+    for (; i < n; i += 16) {
+        __mmask16 m = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __m512 wv = _mm512_fmadd_ps(vg, _mm512_maskz_loadu_ps(m, xPrev + i), _mm512_maskz_loadu_ps(m, w + i));
+        _mm512_mask_storeu_ps(w + i, m, wv);
+        acc0 = _mm512_fmadd_ps(wv, _mm512_maskz_loadu_ps(m, x + i), acc0);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+SIMD_TARGET("avx512f")
+static void clms_step_avx512(float *w, const float *xPrev, float gr, float gi, const float *x, int n, float *yr,
+                             float *yi) {
+    const __m512 oddNegative = _mm512_setr_ps(1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f,
+                                              1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f);
+    __m512 vgr = _mm512_set1_ps(gr), vgi = _mm512_mul_ps(_mm512_set1_ps(-gi), oddNegative);
+    __m512 accR = _mm512_setzero_ps(), accI = _mm512_setzero_ps();
+    for (int i = 0; i < 2 * n; i += 16) {
+        __mmask16 m = 2 * n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (2 * n - i)) - 1);
+        __m512 p = _mm512_maskz_loadu_ps(m, xPrev + i), v = _mm512_maskz_loadu_ps(m, x + i);
+        __m512 wv = _mm512_fmadd_ps(vgr, p, _mm512_maskz_loadu_ps(m, w + i));
+        wv = _mm512_fmadd_ps(vgi, _mm512_permute_ps(p, 0xB1), wv);
+        _mm512_mask_storeu_ps(w + i, m, wv);
+        accR = _mm512_fmadd_ps(wv, v, accR);
+        accI = _mm512_fmadd_ps(wv, _mm512_permute_ps(v, 0xB1), accI);
+    }
+    *yr = _mm512_reduce_add_ps(accR);
+    *yi = _mm512_reduce_add_ps(_mm512_mul_ps(accI, oddNegative));
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static void cscale_avx512(float *x, const float *g, int n) {
+    const __m512i first = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+    const __m512i second = _mm512_setr_epi32(8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15);
+    for (int i = 0; i < n; i += 16) {
+        int left = n - i < 16 ? n - i : 16;   // Gains in this step, 2 * left floats of x
+        int low = left < 8 ? 2 * left : 16;
+        __mmask16 mg = (__mmask16)((1u << left) - 1);
+        __mmask16 m1 = (__mmask16)((1u << low) - 1), m2 = (__mmask16)((1u << (2 * left - low)) - 1);
+        __m512 v = _mm512_maskz_loadu_ps(mg, g + i);
+        __m512 lo = _mm512_permutexvar_ps(first, v), hi = _mm512_permutexvar_ps(second, v);
+        _mm512_mask_storeu_ps(x + 2 * i, m1, _mm512_mul_ps(_mm512_maskz_loadu_ps(m1, x + 2 * i), lo));
+        _mm512_mask_storeu_ps(x + 2 * i + 16, m2, _mm512_mul_ps(_mm512_maskz_loadu_ps(m2, x + 2 * i + 16), hi));
+    }
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static long long lms_step_q15_avx512(short *w, const short *xPrev, short g, const short *x, int n) {
+    __m512i vg = _mm512_set1_epi16(g), floor = _mm512_set1_epi16(-32767);
+    __m512i lowMask = _mm512_set1_epi32(0xFFFF);
+    long long total = 0;
+    int i = 0;
+    while (i < n) {
+        int end = n - i > 32 * Q15_SPLIT_VECTORS ? i + 32 * Q15_SPLIT_VECTORS : n;
+        __m512i hi = _mm512_setzero_si512(), lo = _mm512_setzero_si512();
+        for (; i < end; i += 32) {
+            __m512i wv, xv;
+            if (end - i >= 32) {
+                wv = _mm512_adds_epi16(_mm512_loadu_si512(w + i), _mm512_mulhrs_epi16(vg, _mm512_loadu_si512(xPrev + i)));
+                wv = _mm512_max_epi16(wv, floor);
+                _mm512_storeu_si512(w + i, wv);
+                xv = _mm512_loadu_si512(x + i);
+            } else {
+                // Masked-off lanes load as zero and add nothing
+                __mmask32 m = (__mmask32)((1u << (end - i)) - 1);
+                wv = _mm512_adds_epi16(_mm512_maskz_loadu_epi16(m, w + i),
+                                       _mm512_mulhrs_epi16(vg, _mm512_maskz_loadu_epi16(m, xPrev + i)));
+                wv = _mm512_max_epi16(wv, floor);
+                _mm512_mask_storeu_epi16(w + i, m, wv);
+                xv = _mm512_maskz_loadu_epi16(m, x + i);
+            }
+            __m512i p = _mm512_madd_epi16(wv, xv);
+            hi = _mm512_add_epi32(hi, _mm512_srai_epi32(p, 16));
+            lo = _mm512_add_epi32(lo, _mm512_and_si512(p, lowMask));
+        }
+        total += _mm512_reduce_add_epi64(_mm512_slli_epi64(_mm512_cvtepi32_epi64(_mm512_castsi512_si256(hi)), 16));
+        total += _mm512_reduce_add_epi64(_mm512_slli_epi64(_mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(hi, 1)), 16));
+        total += _mm512_reduce_add_epi64(_mm512_cvtepu32_epi64(_mm512_castsi512_si256(lo)));
+        total += _mm512_reduce_add_epi64(_mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(lo, 1)));
+    }
+    return total;
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static void peak_i16_avx512(const short *x, int n, short *min, short *max, long long *sumSquares) {
+    __m512i vmin = _mm512_set1_epi16(32767), vmax = _mm512_set1_epi16(-32768);
+    __m512i lowMask = _mm512_set1_epi32(0xFFFF);
+    long long total = 0;
+    int i = 0;
+    while (i < n) {
+        int end = n - i > 32 * Q15_SPLIT_VECTORS ? i + 32 * Q15_SPLIT_VECTORS : n;
+        __m512i hi = _mm512_setzero_si512(), lo = _mm512_setzero_si512();
+        for (; i < end; i += 32) {
+            __m512i v;
+            if (end - i >= 32) {
+                v = _mm512_loadu_si512(x + i);
+                vmin = _mm512_min_epi16(vmin, v);
+                vmax = _mm512_max_epi16(vmax, v);
+            } else {
+                // Masked-off lanes load as zero: they add nothing to the
+                // squares and leave min/max untouched
+                __mmask32 m = (__mmask32)((1u << (end - i)) - 1);
+                v = _mm512_maskz_loadu_epi16(m, x + i);
+                vmin = _mm512_mask_min_epi16(vmin, m, vmin, v);
+                vmax = _mm512_mask_max_epi16(vmax, m, vmax, v);
+            }
+            __m512i p = _mm512_madd_epi16(v, v);
+            hi = _mm512_add_epi32(hi, _mm512_srli_epi32(p, 16));
+            lo = _mm512_add_epi32(lo, _mm512_and_si512(p, lowMask));
+        }
+        total += _mm512_reduce_add_epi64(_mm512_slli_epi64(_mm512_cvtepu32_epi64(_mm512_castsi512_si256(hi)), 16));
+        total += _mm512_reduce_add_epi64(_mm512_slli_epi64(_mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(hi, 1)), 16));
+        total += _mm512_reduce_add_epi64(_mm512_cvtepu32_epi64(_mm512_castsi512_si256(lo)));
+        total += _mm512_reduce_add_epi64(_mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(lo, 1)));
+    }
+    // Fold 32 lanes of 16 bits down to one through the 32-bit min/max
+    __m512i min32 = _mm512_min_epi32(_mm512_srai_epi32(_mm512_slli_epi32(vmin, 16), 16), _mm512_srai_epi32(vmin, 16));
+    __m512i max32 = _mm512_max_epi32(_mm512_srai_epi32(_mm512_slli_epi32(vmax, 16), 16), _mm512_srai_epi32(vmax, 16));
+    *min = (short)_mm512_reduce_min_epi32(min32);
+    *max = (short)_mm512_reduce_max_epi32(max32);
+    *sumSquares = total;
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static long long dot_i16_avx512(const short *a, const short *b, int n) {
+    __m512i lowMask = _mm512_set1_epi32(0xFFFF), wrapped = _mm512_set1_epi32((int)0x80000000u);
+    __m512i one = _mm512_set1_epi32(1);
+    long long total = 0;
+    int i = 0;
+    while (i < n) {
+        int end = n - i > 32 * Q15_SPLIT_VECTORS ? i + 32 * Q15_SPLIT_VECTORS : n;
+        __m512i hi = _mm512_setzero_si512(), lo = _mm512_setzero_si512(), wraps = _mm512_setzero_si512();
+        for (; i < end; i += 32) {
+            __m512i va, vb;
+            if (end - i >= 32) {
+                va = _mm512_loadu_si512(a + i);
+                vb = _mm512_loadu_si512(b + i);
+            } else {
+                __mmask32 m = (__mmask32)((1u << (end - i)) - 1);
+                va = _mm512_maskz_loadu_epi16(m, a + i);
+                vb = _mm512_maskz_loadu_epi16(m, b + i);
+            }
+            __m512i p = _mm512_madd_epi16(va, vb);
+            hi = _mm512_add_epi32(hi, _mm512_srai_epi32(p, 16));
+            lo = _mm512_add_epi32(lo, _mm512_and_si512(p, lowMask));
+            wraps = _mm512_mask_add_epi32(wraps, _mm512_cmpeq_epi32_mask(p, wrapped), wraps, one);
+        }
+        total += _mm512_reduce_add_epi64(_mm512_slli_epi64(_mm512_cvtepi32_epi64(_mm512_castsi512_si256(hi)), 16));
+        total += _mm512_reduce_add_epi64(_mm512_slli_epi64(_mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(hi, 1)), 16));
+        total += _mm512_reduce_add_epi64(_mm512_cvtepu32_epi64(_mm512_castsi512_si256(lo)));
+        total += _mm512_reduce_add_epi64(_mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(lo, 1)));
+        total += (long long)_mm512_reduce_add_epi32(wraps) << 32;
+    }
+    return total;
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static void mix_i16_avx512(const short *x, int channels, float *y, float scale, int n) {
+    __m512 vs = _mm512_set1_ps(scale);
+    int i = 0;
+    if (channels == 1) {
+        for (; i + 16 <= n; i += 16) {
+            __m512i v = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(x + i)));
+            _mm512_storeu_ps(y + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), vs));
+        }
+    } else if (channels == 2) {
+        __m512i ones = _mm512_set1_epi16(1);
+        for (; i + 16 <= n; i += 16) {
+            __m512i sum = _mm512_madd_epi16(_mm512_loadu_si512(x + 2 * i), ones);
+            _mm512_storeu_ps(y + i, _mm512_mul_ps(_mm512_cvtepi32_ps(sum), vs));
+        }
+    }
+    mix_i16_tail(x, channels, y, scale, i, n);
+}
+
+SIMD_TARGET("avx512f")
+static void mix_f32_avx512(const float *x, int channels, float *y, float scale, int n) {
+    __m512 vs = _mm512_set1_ps(scale);
+    int i = 0;
+    if (channels == 1) {
+        for (; i + 16 <= n; i += 16) _mm512_storeu_ps(y + i, _mm512_mul_ps(_mm512_loadu_ps(x + i), vs));
+    } else if (channels == 2) {
+        __m512i evens = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0);
+        __m512i odds = _mm512_add_epi32(evens, _mm512_set1_epi32(1));
+        for (; i + 16 <= n; i += 16) {
+            __m512 a = _mm512_loadu_ps(x + 2 * i), b = _mm512_loadu_ps(x + 2 * i + 16);
+            __m512 sum = _mm512_add_ps(_mm512_permutex2var_ps(a, evens, b), _mm512_permutex2var_ps(a, odds, b));
+            _mm512_storeu_ps(y + i, _mm512_mul_ps(sum, vs));
+        }
+    }
+    mix_f32_tail(x, channels, y, scale, i, n);
+}
+
+SIMD_TARGET("avx512f")
+static void f32_to_i16_avx512(const float *x, short *y, float scale, int n) {
+    __m512 vs = _mm512_set1_ps(scale), lo = _mm512_set1_ps(-32768.0f), hi = _mm512_set1_ps(32767.0f);
+    __m512i sign = _mm512_set1_epi32((int)0x80000000), half = _mm512_castps_si512(_mm512_set1_ps(0.5f));
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 a = _mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(_mm512_loadu_ps(x + i), vs), lo), hi);
+        __m512i bits = _mm512_or_si512(_mm512_and_si512(_mm512_castps_si512(a), sign), half);
+        a = _mm512_add_ps(a, _mm512_castsi512_ps(bits));
+        _mm256_storeu_si256((__m256i *)(y + i), _mm512_cvtsepi32_epi16(_mm512_cvttps_epi32(a)));
+    }
+    f32_to_i16_tail(x, y, scale, i, n);
+}
+
+SIMD_TARGET("avx512f")
+static double dot_f64_avx512(const double *a, const double *b, int n) {
+    __m512d acc = _mm512_setzero_pd();
+    for (int i = 0; i < n; i += 8) {
+        __mmask8 m = n - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        acc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a + i), _mm512_maskz_loadu_pd(m, b + i), acc);
+    }
+    return _mm512_reduce_add_pd(acc);
+}
+
+SIMD_TARGET("avx512f")
+static void axpy_f64_avx512(double *y, const double *x, double a, int n) {
+    __m512d va = _mm512_set1_pd(a);
+    for (int i = 0; i < n; i += 8) {
+        __mmask8 m = n - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        __m512d v = _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + i), _mm512_maskz_loadu_pd(m, y + i));
+        _mm512_mask_storeu_pd(y + i, m, v);
+    }
+}
+
+SIMD_TARGET("avx512f")
+static void axpby_f64_avx512(double *y, const double *x, double a, double b, int n) {
+    __m512d va = _mm512_set1_pd(a), vb = _mm512_set1_pd(b);
+    for (int i = 0; i < n; i += 8) {
+        __mmask8 m = n - i >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1);
+        __m512d v = _mm512_fmadd_pd(vb, _mm512_maskz_loadu_pd(m, x + i), _mm512_mul_pd(va, _mm512_maskz_loadu_pd(m, y + i)));
+        _mm512_mask_storeu_pd(y + i, m, v);
+    }
+}
+
+#endif // SIMD_X86
+
+static const KernelSet kernelSets[] = {
+    {"scalar", dot_scalar, sqdiff_scalar, axpy_scalar, lms_step_scalar, clms_step_scalar,
+     cscale_scalar, dot_f64_scalar, axpy_f64_scalar, axpby_f64_scalar, lms_step_q15_scalar, peak_i16_scalar,
+     dot_i16_scalar, mix_i16_scalar, mix_f32_scalar, f32_to_i16_scalar},
+#ifdef SIMD_X86
+    {"sse2", dot_sse2, sqdiff_sse2, axpy_sse2, lms_step_sse2, clms_step_sse2,
+     cscale_sse2, dot_f64_sse2, axpy_f64_sse2, axpby_f64_sse2, lms_step_q15_sse2, peak_i16_sse2,
+     dot_i16_sse2, mix_i16_sse2, mix_f32_sse2, f32_to_i16_sse2},
+    {"avx2", dot_avx2, sqdiff_avx2, axpy_avx2, lms_step_avx2, clms_step_avx2,
+     cscale_avx2, dot_f64_avx2, axpy_f64_avx2, axpby_f64_avx2, lms_step_q15_avx2, peak_i16_avx2,
+     dot_i16_avx2, mix_i16_avx2, mix_f32_avx2, f32_to_i16_avx2},
+    {"avx512", dot_avx512, sqdiff_avx512, axpy_avx512, lms_step_avx512, clms_step_avx512,
+     cscale_avx512, dot_f64_avx512, axpy_f64_avx512, axpby_f64_avx512, lms_step_q15_avx512, peak_i16_avx512,
+     dot_i16_avx512, mix_i16_avx512, mix_f32_avx512, f32_to_i16_avx512},
+#endif
+};
+
+static const KernelSet *active = NULL;
+
+static int level_supported(const char *name) {
+    if (strcmp(name, "scalar") == 0) return 1;
+#if defined(SIMD_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (strcmp(name, "sse2") == 0) return __builtin_cpu_supports("sse2");
+    if (strcmp(name, "avx2") == 0) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (strcmp(name, "avx512") == 0) return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#elif defined(SIMD_X86)
+    if (strcmp(name, "sse2") == 0) return 1; // Baseline on x86-64
+#endif
+    return 0;
+}
+
+int simd_select(const char *level) {
+    int count = (int)(sizeof(kernelSets) / sizeof(kernelSets[0]));
+
+    if (!level) {
+        for (int i = count - 1; i >= 0; i--) {
+            if (level_supported(kernelSets[i].name)) {
+                active = &kernelSets[i];
+                return 0;
+            }
+        }
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (strcmp(kernelSets[i].name, level) == 0 && level_supported(level)) {
+            active = &kernelSets[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+#if defined(__GNUC__)
+// Pick the kernels before main() so worker threads never race on the first call
+__attribute__((constructor)) static void select_at_startup(void) {
+    simd_select(NULL);
+}
+#endif
+
+static const KernelSet *kernels(void) {
+    if (!active) simd_select(NULL);
+    return active;
+}
+
+const char *simd_level(void) {
+    return kernels()->name;
+}
+
+float simd_dot_f32(const float *a, const float *b, int n) {
+    return kernels()->dot(a, b, n);
+}
+
+float simd_sqdiff_f32(const float *a, const float *b, int n) {
+    return kernels()->sqdiff(a, b, n);
+}
+
+void simd_axpy_f32(float *y, const float *x, float a, int n) {
+    kernels()->axpy(y, x, a, n);
+}
+
+float simd_lms_step_f32(float *w, const float *xPrev, float g, const float *x, int n) {
+    return kernels()->lmsStep(w, xPrev, g, x, n);
+}
+
+void simd_clms_step_f32(float *w, const float *xPrev, float gr, float gi, const float *x, int n, float *yr,
+                        float *yi) {
+    kernels()->clmsStep(w, xPrev, gr, gi, x, n, yr, yi);
+}
+
+void simd_cscale_f32(float *x, const float *g, int n) {
+    kernels()->cscale(x, g, n);
+}
+
+double simd_dot_f64(const double *a, const double *b, int n) {
+    return kernels()->dotF64(a, b, n);
+}
+
+void simd_axpy_f64(double *y, const double *x, double a, int n) {
+    kernels()->axpyF64(y, x, a, n);
+}
+
+void simd_axpby_f64(double *y, const double *x, double a, double b, int n) {
+    kernels()->axpbyF64(y, x, a, b, n);
+}
+
+long long simd_lms_step_q15(short *w, const short *xPrev, short g, const short *x, int n) {
+    return kernels()->lmsStepQ15(w, xPrev, g, x, n);
+}
+
+void simd_peak_i16(const short *x, int n, short *min, short *max, long long *sumSquares) {
+    kernels()->peakI16(x, n, min, max, sumSquares);
+}
+
+long long simd_dot_i16(const short *a, const short *b, int n) {
+    return kernels()->dotI16(a, b, n);
+}
+
+void simd_mix_i16_f32(const short *x, int channels, float *y, float scale, int n) {
+    kernels()->mixI16(x, channels, y, scale, n);
+}
+
+void simd_mix_f32(const float *x, int channels, float *y, float scale, int n) {
+    kernels()->mixF32(x, channels, y, scale, n);
+}
+
+void simd_f32_to_i16(const float *x, short *y, float scale, int n) {
+    kernels()->f32ToI16(x, y, scale, n);
+}
@@ -0,0 +1,80 @@
+// Vector kernels for the adaptive filter hot loops.
+//
+// Each kernel has scalar, SSE2, AVX2/FMA and AVX-512 (F + BW) versions. The
+// fastest one the CPU supports is picked at start-up (on first use where the
+// compiler has no constructor attribute); simd_select() can force a specific
+// level (for benchmarking or to reproduce results) and must not be called
+// while other threads are filtering.
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sum of a[i] * b[i]
+float simd_dot_f32(const float *a, const float *b, int n);
+
+// Sum of (a[i] - b[i])^2
+float simd_sqdiff_f32(const float *a, const float *b, int n);
+
+// y[i] += a * x[i]
+void simd_axpy_f32(float *y, const float *x, float a, int n);
+
+// Fused LMS step: applies the previous sample's update w[i] += g * xPrev[i]
+// and returns the next output sum(w[i] * x[i]) in the same pass over w.
+// With a time-ordered history, xPrev is simply x - 1.
+float simd_lms_step_f32(float *w, const float *xPrev, float g, const float *x, int n);
+
+// Complex form of the fused LMS step for the subband filters. w, xPrev and x
+// hold n complex values as interleaved [re, im] pairs. Applies
+// w[i] += g * xPrev[i] with g = gr + i * gi, then writes the next output
+// sum(conj(w[i]) * x[i]) to yr and yi in the same pass over w.
+void simd_clms_step_f32(float *w, const float *xPrev, float gr, float gi, const float *x, int n, float *yr,
+                        float *yi);
+
+// x[i] *= g[i] for n complex values x, as interleaved [re, im] pairs, and
+// real gains g: a gain per frequency bin applied to a spectrum
+void simd_cscale_f32(float *x, const float *g, int n);
+
+// Double-precision kernels for the RLS updates
+double simd_dot_f64(const double *a, const double *b, int n);
+
+// y[i] += a * x[i]
+void simd_axpy_f64(double *y, const double *x, double a, int n);
+
+// y[i] = a * y[i] + b * x[i]
+void simd_axpby_f64(double *y, const double *x, double a, double b, int n);
+
+// Q15 fused LMS step, bit-exact across levels: w[i] += round(g * xPrev[i] / 2^15)
+// with saturation, each weight kept within +-32767, then the exact sum of
+// w[i] * x[i] (Q30). g must not be -32768.
+long long simd_lms_step_q15(short *w, const short *xPrev, short g, const short *x, int n);
+
+// Smallest and largest of x[0..n) and the exact sum of x[i]^2, for waveform
+// peak envelopes. n must be at least 1.
+void simd_peak_i16(const short *x, int n, short *min, short *max, long long *sumSquares);
+
+// Exact sum of a[i] * b[i] over 16-bit samples, for energies measured
+// without converting to float
+long long simd_dot_i16(const short *a, const short *b, int n);
+
+// Sample format conversion, bit-exact across levels. The mixes take n
+// interleaved frames and write y[i] = scale * (sum of frame i's channels);
+// mono and stereo are vectorised.
+void simd_mix_i16_f32(const short *x, int channels, float *y, float scale, int n);
+void simd_mix_f32(const float *x, int channels, float *y, float scale, int n);
+
+// y[i] = x[i] * scale rounded half away from zero and saturated to 16 bits
+void simd_f32_to_i16(const float *x, short *y, float scale, int n);
+
+// Force a kernel level: "scalar", "sse2", "avx2" or "avx512"; NULL picks the
+// best supported one. Returns 0 on success, -1 if the level is unavailable.
+int simd_select(const char *level);
+const char *simd_level(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIMD_KERNELS_H
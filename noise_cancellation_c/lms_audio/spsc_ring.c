@@ -0,0 +1,20 @@
+#include "spsc_ring.h"
+
+#include <stdlib.h>
+
+int spsc_ring_init(SPSCRing *r, size_t slots, size_t slotSize) {
+    size_t count = 1;
+    while (count < slots) count <<= 1;
+
+    r->slotSize = (slotSize + 15) & ~(size_t)15;
+    r->mask = count - 1;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    r->slots = (unsigned char *)calloc(count, r->slotSize);
+    return r->slots ? 0 : -1;
+}
+
+void spsc_ring_free(SPSCRing *r) {
+    free(r->slots);
+    r->slots = NULL;
+}
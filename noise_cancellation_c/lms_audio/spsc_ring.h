@@ -0,0 +1,59 @@
+// Lock-free single-producer/single-consumer ring of fixed-size slots.
+//
+// One thread writes, one thread reads, and neither ever blocks or takes a
+// lock: the producer fills the slot returned by spsc_ring_write_slot() and
+// publishes it with spsc_ring_commit(); the consumer reads the slot from
+// spsc_ring_read_slot() in place and hands it back with spsc_ring_release().
+// The head and tail counters sit on separate cache lines so the two threads
+// do not false-share. Requires C11 atomics.
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define SPSC_CACHE_LINE 64
+
+typedef struct {
+    size_t slotSize;        // Bytes per slot, rounded up to 16
+    size_t mask;            // Slot count - 1 (slot count is a power of two)
+    unsigned char *slots;
+
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t head;   // Next slot to write, owned by the producer
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t tail;   // Next slot to read, owned by the consumer
+} SPSCRing;
+
+// slots is rounded up to a power of two. Returns 0 on success, -1 if the
+// buffer could not be allocated.
+int spsc_ring_init(SPSCRing *r, size_t slots, size_t slotSize);
+void spsc_ring_free(SPSCRing *r);
+
+// Producer: free slot to fill, or NULL when the ring is full
+static inline void *spsc_ring_write_slot(SPSCRing *r) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail > r->mask) return NULL;
+    return r->slots + (head & r->mask) * r->slotSize;
+}
+
+// Producer: publish the slot filled after spsc_ring_write_slot()
+static inline void spsc_ring_commit(SPSCRing *r) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+}
+
+// Consumer: oldest published slot, or NULL when the ring is empty
+static inline void *spsc_ring_read_slot(SPSCRing *r) {
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (tail == head) return NULL;
+    return r->slots + (tail & r->mask) * r->slotSize;
+}
+
+// Consumer: return the slot from spsc_ring_read_slot() to the producer
+static inline void spsc_ring_release(SPSCRing *r) {
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+}
+
+#endif // SPSC_RING_H
@@ -0,0 +1,131 @@
+#include "stft.h"
+#include "simd_kernels.h"
+#include "dsp_math.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define POWER_SMOOTHING 0.7f     // Weight of the previous frame in the smoothed power
+#define NOISE_BIAS 2.5f          // The floor follows the troughs of the power, well below its mean
+#define DECISION_DIRECTED 0.98f  // Weight of the last frame's cleaned power in the a-priori SNR
+#define STFT_EPS 1e-12f          // Keeps the SNRs finite on digital silence
+
+int stft_init(STFTDenoiser *s, int frame) {
+    memset(s, 0, sizeof(*s));
+    if (frame < 16 || (frame & (frame - 1)) != 0) return -1;
+    s->frame = frame;
+    s->hop = frame / 2;
+    s->bins = frame / 2 + 1;
+    s->plan = fft_plan_get(frame);
+    if (!s->plan) return -1;
+
+    s->window = (float *)malloc(frame * sizeof(float));
+    s->input = (float *)calloc(frame, sizeof(float));
+    s->overlap = (float *)calloc(frame, sizeof(float));
+    s->ready = (float *)calloc(s->hop, sizeof(float));
+    s->buffer = (float *)malloc(frame * sizeof(float));
+    s->spectrum = (float *)malloc(2 * s->bins * sizeof(float));
+    s->power = (float *)calloc(s->bins, sizeof(float));
+    s->noise = (float *)calloc(s->bins, sizeof(float));
+    s->clean = (float *)calloc(s->bins, sizeof(float));
+    s->gain = (float *)malloc(s->bins * sizeof(float));
+    if (!s->window || !s->input || !s->overlap || !s->ready || !s->buffer || !s->spectrum || !s->power ||
+        !s->noise || !s->clean || !s->gain) {
+        stft_free(s);
+        return -1;
+    }
+
+    // Periodic Hann, square-rooted: sin^2 of two frames half apart adds up to 1
+    for (int i = 0; i < frame; i++) s->window[i] = (float)sin(DSP_PI * i / frame);
+    return 0;
+}
+
+void stft_reset(STFTDenoiser *s) {
+    memset(s->input, 0, s->frame * sizeof(float));
+    memset(s->overlap, 0, s->frame * sizeof(float));
+    memset(s->ready, 0, s->hop * sizeof(float));
+    memset(s->power, 0, s->bins * sizeof(float));
+    memset(s->noise, 0, s->bins * sizeof(float));
+    memset(s->clean, 0, s->bins * sizeof(float));
+    s->started = 0;
+    s->fill = 0;
+}
+
+void stft_free(STFTDenoiser *s) {
+    free(s->window);
+    free(s->input);
+    free(s->overlap);
+    free(s->ready);
+    free(s->buffer);
+    free(s->spectrum);
+    free(s->power);
+    free(s->noise);
+    free(s->clean);
+    free(s->gain);
+    s->window = s->input = s->overlap = s->ready = s->buffer = NULL;
+    s->spectrum = s->power = s->noise = s->clean = s->gain = NULL;
+}
+
+int stft_latency(const STFTDenoiser *s) {
+    return s->frame;
+}
+
+// Gain of every bin of s->spectrum; the first frame starts the noise floor
+// at its own power
+static void update_gains(STFTDenoiser *s) {
+    int first = !s->started;
+    for (int k = 0; k < s->bins; k++) {
+        float re = s->spectrum[2 * k], im = s->spectrum[2 * k + 1];
+        float power = re * re + im * im;
+
+        s->power[k] = first ? power : POWER_SMOOTHING * s->power[k] + (1.0f - POWER_SMOOTHING) * power;
+        s->noise[k] = first || s->power[k] < s->noise[k] ? s->power[k] : s->noise[k] * STFT_NOISE_RISE;
+
+        float noise = NOISE_BIAS * s->noise[k] + STFT_EPS;
+        float subtracted = power > noise ? power / noise - 1.0f : 0.0f;
+        float xi = first ? subtracted
+                         : DECISION_DIRECTED * s->clean[k] / noise + (1.0f - DECISION_DIRECTED) * subtracted;
+        float gain = xi / (1.0f + xi);
+        if (gain < STFT_GAIN_FLOOR) gain = STFT_GAIN_FLOOR;
+
+        s->gain[k] = gain;
+        s->clean[k] = gain * gain * power;
+    }
+    s->started = 1;
+}
+
+static void hop(STFTDenoiser *s) {
+    int frame = s->frame, hopSize = s->hop;
+    for (int i = 0; i < frame; i++) s->buffer[i] = s->window[i] * s->input[i];
+    fft_real_forward(s->plan, s->buffer, s->spectrum);
+    update_gains(s);
+    simd_cscale_f32(s->spectrum, s->gain, s->bins);
+    fft_real_inverse(s->plan, s->spectrum, s->buffer);
+
+    // The first half of the accumulator now has both of its frames
+    for (int i = 0; i < frame; i++) s->overlap[i] += s->window[i] * s->buffer[i];
+    memcpy(s->ready, s->overlap, hopSize * sizeof(float));
+    memmove(s->overlap, s->overlap + hopSize, (frame - hopSize) * sizeof(float));
+    memset(s->overlap + frame - hopSize, 0, hopSize * sizeof(float));
+    memmove(s->input, s->input + hopSize, (frame - hopSize) * sizeof(float));
+}
+
+void stft_process(STFTDenoiser *s, const float *d, float *out, int count) {
+    int hopSize = s->hop, tail = s->frame - s->hop;
+    while (count > 0) {
+        int n = hopSize - s->fill < count ? hopSize - s->fill : count;
+
+        // Each sample of a hop trades places with a sample of the last one
+        memcpy(s->input + tail + s->fill, d, n * sizeof(float));
+        memcpy(out, s->ready + s->fill, n * sizeof(float));
+        s->fill += n;
+        if (s->fill == hopSize) {
+            hop(s);
+            s->fill = 0;
+        }
+        d += n;
+        out += n;
+        count -= n;
+    }
+}
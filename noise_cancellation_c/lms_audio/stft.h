@@ -0,0 +1,70 @@
+// Single-channel STFT noise suppression.
+//
+// The input is cut into frames of `frame` samples, half overlapping, each
+// weighted by a square-root Hann window and transformed. Every bin gets a
+// gain from the noise floor below it and the windowed inverse transforms
+// are overlap-added back together; with the same window on both sides the
+// frames add up to the input exactly when all gains are 1.
+//
+// The noise floor of a bin follows the minimum of its smoothed power: it
+// drops with the power at once and otherwise rises by STFT_NOISE_RISE per
+// frame, so it stays down through speech and music and catches up with
+// louder noise within seconds. The gain is the Wiener gain xi / (1 + xi),
+// where the a-priori SNR xi mixes the spectral subtraction estimate
+// (power - noise) / noise of this frame with the cleaned power of the last
+// one (the decision-directed rule), which keeps the gains from flickering
+// into musical noise. Gains never drop below STFT_GAIN_FLOOR.
+//
+// All buffers are sized by the frame length at init. Output is delayed by
+// stft_latency() samples, one frame.
+#ifndef STFT_H
+#define STFT_H
+
+#include "fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STFT_NOISE_RISE 1.002f   // Per frame, about 1.5 dB/s at 44.1 kHz and 512-sample frames
+#define STFT_GAIN_FLOOR 0.1f     // -20 dB
+
+typedef struct {
+    int frame;         // Transform length, a power of two
+    int hop;           // frame / 2
+    int bins;          // frame / 2 + 1
+    const FFTPlan *plan;
+
+    float *window;     // Square-root Hann, `frame` taps
+    float *input;      // Last `frame` input samples, oldest first
+    float *overlap;    // Overlap-add accumulator, `frame` samples
+    float *ready;      // Output of the last hop, `hop` samples
+    float *buffer;     // Windowed frame, `frame` samples
+    float *spectrum;   // bins complex values
+
+    // Per bin
+    float *power;      // Smoothed power
+    float *noise;      // Noise floor
+    float *clean;      // Cleaned power of the last frame
+    float *gain;
+
+    int started;       // Non-zero once a frame has been analysed
+    int fill;          // Samples collected towards the next hop
+} STFTDenoiser;
+
+// Returns 0 on success, -1 for a bad frame length or allocation failure.
+int stft_init(STFTDenoiser *s, int frame);
+void stft_reset(STFTDenoiser *s);
+void stft_free(STFTDenoiser *s);
+
+// Samples between an input and its output
+int stft_latency(const STFTDenoiser *s);
+
+// Clean `count` samples of d into out
+void stft_process(STFTDenoiser *s, const float *d, float *out, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STFT_H
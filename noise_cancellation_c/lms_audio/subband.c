@@ -0,0 +1,218 @@
+#include "subband.h"
+#include "simd_kernels.h"
+#include "dsp_math.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SUBBAND_EPS 1e-8f     // Keeps the step bounded in a silent band
+#define KAISER_BETA 2.0       // Taper of the truncated prototype
+
+// Root-raised-cosine prototype with roll-off 1: the response is
+// cos(w * bands / 4) for |w| < 2 * pi / bands and zero beyond, so each band
+// reaches exactly to the centres of its neighbours (the decimated Nyquist
+// rate) and the squared responses of all bands add up to a constant. With
+// the same pulse for analysis and synthesis the bank then reconstructs its
+// input up to the truncation error.
+static void build_prototype(SubbandFilter *s) {
+    int length = s->length;
+    double quarter = s->bands / 4.0, norm = bessel_i0(KAISER_BETA), sum = 0.0, power = 0.0;
+    for (int i = 0; i < length; i++) {
+        double t = i - (length - 1) / 2.0;   // Never 0 or +-quarter: length is even
+        double x = 2.0 * t / length;
+        double taper = bessel_i0(KAISER_BETA * sqrt(1.0 - x * x)) / norm;
+        double pulse = cos(2.0 * DSP_PI * t / s->bands) * (1.0 / (quarter - t) + 1.0 / (quarter + t));
+        s->analysis[i] = (float)(pulse * taper);
+        sum += s->analysis[i];
+    }
+
+    // Unit gain at DC for the analysis; the synthesis makes up the rest so a
+    // hop of unchanged subbands gives the input back
+    for (int i = 0; i < length; i++) {
+        s->analysis[i] = (float)(s->analysis[i] / sum);
+        power += (double)s->analysis[i] * s->analysis[i];
+    }
+    for (int i = 0; i < length; i++) s->synthesis[i] = (float)(s->analysis[i] * s->hop / power);
+}
+
+int subband_init(SubbandFilter *s, int bands, int overlap, int taps, float mu) {
+    memset(s, 0, sizeof(*s));
+    if (bands < 8 || (bands & (bands - 1)) != 0 || overlap < 1 || taps <= 0) return -1;
+    s->bands = bands;
+    s->hop = bands / 2;
+    s->length = overlap * bands;
+    s->subbands = bands / 2 + 1;
+    s->delay = s->length / 2 + 1;   // Makes the latency a multiple of the hop
+    // The filterbank spreads the delayed path by half a prototype on each side
+    s->subTaps = (taps + 2 * s->length + s->hop - 1) / s->hop;
+    s->mu = mu;
+    s->plan = fft_plan_get(bands);
+    if (!s->plan) return -1;
+
+    size_t history = (size_t)s->subbands * 2 * (s->subTaps + SUBBAND_HISTORY);
+    size_t weights = (size_t)s->subbands * 2 * s->subTaps;
+    s->analysis = (float *)malloc(s->length * sizeof(float));
+    s->synthesis = (float *)malloc(s->length * sizeof(float));
+    s->inX = (float *)calloc(s->length, sizeof(float));
+    s->inD = (float *)calloc(s->length + s->delay, sizeof(float));
+    s->overlap = (float *)calloc(s->length, sizeof(float));
+    s->ready = (float *)calloc(s->hop, sizeof(float));
+    s->fold = (float *)malloc(bands * sizeof(float));
+    s->specX = (float *)malloc((bands + 2) * sizeof(float));
+    s->specD = (float *)malloc((bands + 2) * sizeof(float));
+    s->history = (float *)calloc(history, sizeof(float));
+    s->weights = (float *)calloc(weights, sizeof(float));
+    s->step = (float *)calloc(2 * s->subbands, sizeof(float));
+    s->energy = (float *)calloc(s->subbands, sizeof(float));
+    if (!s->analysis || !s->synthesis || !s->inX || !s->inD || !s->overlap || !s->ready || !s->fold ||
+        !s->specX || !s->specD || !s->history || !s->weights || !s->step || !s->energy) {
+        subband_free(s);
+        return -1;
+    }
+    build_prototype(s);
+    s->pos = s->subTaps;
+    return 0;
+}
+
+void subband_reset(SubbandFilter *s) {
+    memset(s->inX, 0, s->length * sizeof(float));
+    memset(s->inD, 0, (s->length + s->delay) * sizeof(float));
+    memset(s->overlap, 0, s->length * sizeof(float));
+    memset(s->ready, 0, s->hop * sizeof(float));
+    memset(s->history, 0, (size_t)s->subbands * 2 * (s->subTaps + SUBBAND_HISTORY) * sizeof(float));
+    memset(s->weights, 0, (size_t)s->subbands * 2 * s->subTaps * sizeof(float));
+    memset(s->step, 0, 2 * s->subbands * sizeof(float));
+    memset(s->energy, 0, s->subbands * sizeof(float));
+    s->pos = s->subTaps;
+    s->fill = 0;
+}
+
+void subband_free(SubbandFilter *s) {
+    free(s->analysis);
+    free(s->synthesis);
+    free(s->inX);
+    free(s->inD);
+    free(s->overlap);
+    free(s->ready);
+    free(s->fold);
+    free(s->specX);
+    free(s->specD);
+    free(s->history);
+    free(s->weights);
+    free(s->step);
+    free(s->energy);
+    s->analysis = s->synthesis = s->inX = s->inD = s->overlap = s->ready = NULL;
+    s->fold = s->specX = s->specD = s->history = s->weights = s->step = s->energy = NULL;
+}
+
+int subband_latency(const SubbandFilter *s) {
+    return s->length - 1 + s->delay;
+}
+
+// Window the last `length` samples, fold them onto one DFT length and
+// transform: bands / 2 + 1 subband samples. The loops run over groups of 8
+// (bands is a multiple of 8) so the compiler can vectorise them at -O2.
+static void analyse(SubbandFilter *s, const float *in, float *spectrum) {
+    int bands = s->bands;
+    for (int j = 0; j < bands; j += 8) {
+        float acc[8];
+        for (int m = 0; m < 8; m++) acc[m] = s->analysis[j + m] * in[j + m];
+        for (int i = bands + j; i < s->length; i += bands) {
+            for (int m = 0; m < 8; m++) acc[m] += s->analysis[i + m] * in[i + m];
+        }
+        for (int m = 0; m < 8; m++) s->fold[j + m] = acc[m];
+    }
+    fft_real_forward(s->plan, s->fold, spectrum);
+}
+
+// One decimated step of every subband filter: the bands are independent,
+// and each is one fused complex LMS step over its contiguous window that
+// applies the previous hop's update and filters the new sample. The error
+// E[k] = D[k] - sum conj(w[j]) X[k - j] is left in specD.
+static void adapt(SubbandFilter *s) {
+    int taps = s->subTaps, stride = 2 * (taps + SUBBAND_HISTORY);
+
+    // Keep the last window and the sample before it, which the pending
+    // update still refers to
+    if (s->pos == taps + SUBBAND_HISTORY) {
+        for (int k = 0; k < s->subbands; k++) {
+            float *h = s->history + (size_t)k * stride;
+            memmove(h, h + 2 * (s->pos - taps), 2 * taps * sizeof(float));
+        }
+        s->pos = taps;
+    }
+
+    for (int k = 0; k < s->subbands; k++) {
+        float *h = s->history + (size_t)k * stride;
+        float *w = s->weights + (size_t)k * 2 * taps;
+        float *window = h + 2 * (s->pos - taps + 1);
+        float xr = s->specX[2 * k], xi = s->specX[2 * k + 1];
+        float yr, yi;
+
+        // The new sample enters the window and the oldest one leaves
+        s->energy[k] += xr * xr + xi * xi - (window[-2] * window[-2] + window[-1] * window[-1]);
+        if (s->energy[k] < 0.0f) s->energy[k] = 0.0f;
+        h[2 * s->pos] = xr;
+        h[2 * s->pos + 1] = xi;
+
+        simd_clms_step_f32(w, window - 2, s->step[2 * k], s->step[2 * k + 1], window, taps, &yr, &yi);
+        float er = s->specD[2 * k] - yr;
+        float ei = s->specD[2 * k + 1] - yi;
+        s->specD[2 * k] = er;
+        s->specD[2 * k + 1] = ei;
+
+        // Applied next hop: w += mu * x * conj(e) / |x|^2
+        float g = s->mu / (SUBBAND_EPS + s->energy[k]);
+        s->step[2 * k] = g * er;
+        s->step[2 * k + 1] = -g * ei;
+    }
+    s->pos++;
+}
+
+static void hop(SubbandFilter *s) {
+    int bands = s->bands, hopSize = s->hop, length = s->length;
+    analyse(s, s->inX, s->specX);
+    analyse(s, s->inD, s->specD);
+    adapt(s);
+
+    // Synthesis: the error spectrum back to one DFT length, repeated over the
+    // prototype and overlap-added; the first hop samples are then complete
+    fft_real_inverse(s->plan, s->specD, s->fold);
+    for (int i = 0; i < length; i += bands) {
+        for (int j = 0; j < bands; j += 8) {
+            for (int m = 0; m < 8; m++) s->overlap[i + j + m] += s->synthesis[i + j + m] * s->fold[j + m];
+        }
+    }
+    memcpy(s->ready, s->overlap, hopSize * sizeof(float));
+    memmove(s->overlap, s->overlap + hopSize, (length - hopSize) * sizeof(float));
+    memset(s->overlap + length - hopSize, 0, hopSize * sizeof(float));
+
+    memmove(s->inX, s->inX + hopSize, (length - hopSize) * sizeof(float));
+    memmove(s->inD, s->inD + hopSize, (length + s->delay - hopSize) * sizeof(float));
+}
+
+void subband_process(SubbandFilter *s, const float *x, const float *d, float *e, int count) {
+    int hopSize = s->hop, tail = s->length - hopSize;
+    while (count > 0) {
+        int n = hopSize - s->fill < count ? hopSize - s->fill : count;
+        memcpy(s->inX + tail + s->fill, x, n * sizeof(float));
+        memcpy(s->inD + tail + s->delay + s->fill, d, n * sizeof(float));
+
+        // The sample that completes a hop gets the first output of that hop,
+        // the others the rest of the previous one
+        if (s->fill + n < hopSize) {
+            memcpy(e, s->ready + s->fill + 1, n * sizeof(float));
+            s->fill += n;
+        } else {
+            memcpy(e, s->ready + s->fill + 1, (n - 1) * sizeof(float));
+            hop(s);
+            e[n - 1] = s->ready[0];
+            s->fill = 0;
+        }
+        x += n;
+        d += n;
+        e += n;
+        count -= n;
+    }
+}
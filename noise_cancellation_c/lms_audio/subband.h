@@ -0,0 +1,75 @@
+// Subband adaptive filter on an oversampled DFT filterbank.
+//
+// Both inputs are split by a weighted overlap-add (WOLA) analysis bank into
+// bands / 2 + 1 complex subbands, decimated by bands / 2 (twice
+// oversampled, so the bands do not alias into each other). Each subband has
+// its own short complex NLMS filter, and the subband errors are put back
+// together by the matching synthesis bank. A full-band filter of `taps`
+// taps becomes about taps / hop taps per band, run at 1 / hop of the rate,
+// which for long filters is several times less work per sample than
+// full-band LMS; the filterbank itself costs a fixed amount per sample, so
+// short filters gain nothing. Each band is normalized by its own power, so
+// coloured noise converges about as fast as white noise.
+//
+// The prototype is a root-raised-cosine pulse band-limited to one band
+// spacing, truncated to `overlap` * bands taps. Longer prototypes
+// reconstruct more accurately but delay the output more. The filterbank
+// spreads the noise path by about half a prototype in both directions, so
+// the primary is held back by that much to keep the subband paths causal.
+//
+// Output is delayed by subband_latency() samples: 1.5 * overlap * bands.
+#ifndef SUBBAND_H
+#define SUBBAND_H
+
+#include "fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SUBBAND_HISTORY 64   // Hops between compactions of the subband histories
+
+typedef struct {
+    int bands;         // DFT size, a power of two
+    int hop;           // Decimation, bands / 2
+    int length;        // Prototype length, overlap * bands
+    int subbands;      // bands / 2 + 1
+    int subTaps;       // Complex taps per subband
+    int delay;         // Samples the primary is held back, length / 2 + 1
+    float mu;
+    const FFTPlan *plan;
+
+    float *analysis;   // Prototype, `length` taps
+    float *synthesis;  // Prototype scaled for unit gain
+    float *inX;        // Last `length` reference samples, oldest first
+    float *inD;        // Last length + delay primary samples, oldest first
+    float *overlap;    // Synthesis overlap-add accumulator, `length` samples
+    float *ready;      // Output of the last hop, `hop` samples
+    float *fold, *specX, *specD;
+
+    // Per subband, as interleaved [re, im] pairs: the reference history,
+    // subTaps + SUBBAND_HISTORY samples compacted when full, and the weights
+    float *history, *weights;
+    float *step;       // Per subband: the pending update mu * conj(e) / |x|^2
+    float *energy;     // Per subband: |x|^2 over the window
+    int pos;           // History index the next subband sample goes to
+    int fill;          // Samples collected towards the next hop
+} SubbandFilter;
+
+// taps is the equivalent full-band filter length. Returns 0 on success, -1
+// for a bad size or allocation failure.
+int subband_init(SubbandFilter *s, int bands, int overlap, int taps, float mu);
+void subband_reset(SubbandFilter *s);
+void subband_free(SubbandFilter *s);
+
+// Samples between an input and its output
+int subband_latency(const SubbandFilter *s);
+
+// Same contract as lms_stream_process(), apart from the latency
+void subband_process(SubbandFilter *s, const float *x, const float *d, float *e, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SUBBAND_H
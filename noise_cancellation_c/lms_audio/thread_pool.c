@@ -0,0 +1,300 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // pthread_setaffinity_np
+#endif
+
+#include "thread_pool.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+    TaskFn fn;
+    void *arg;
+} Task;
+
+// Growable circular deque. The owner pushes and pops at the bottom (newest),
+// thieves take from the top (oldest).
+typedef struct {
+    pthread_mutex_t lock;
+    Task *tasks;
+    int capacity;
+    int top;        // Index of the oldest task
+    int count;
+} TaskDeque;
+
+typedef struct {
+    ThreadPool *pool;
+    int index;
+    pthread_t thread;
+    TaskDeque deque;
+} Worker;
+
+struct ThreadPool {
+    Worker *workers;
+    int threadCount;         // Workers with a deque
+    int started;             // Workers whose thread is running
+    int flags;
+
+    atomic_int queued;       // Tasks sitting in a deque
+    atomic_int unfinished;   // Tasks submitted but not yet finished
+    atomic_uint nextDeque;   // Round-robin target for outside submissions
+    atomic_long steals;
+
+    // Only used to put idle workers and waiters to sleep
+    pthread_mutex_t lock;
+    pthread_cond_t workReady;
+    pthread_cond_t allDone;
+    int shutdown;
+};
+
+// Worker running on this thread, NULL outside any pool
+static _Thread_local Worker *currentWorker;
+
+int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static void pin_to_cpu(int cpu) {
+#if defined(_WIN32)
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (cpu % (8 * sizeof(DWORD_PTR))));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu; // No affinity API; leave placement to the scheduler
+#endif
+}
+
+static int deque_init(TaskDeque *q) {
+    q->capacity = 64;
+    q->top = 0;
+    q->count = 0;
+    q->tasks = (Task *)malloc(q->capacity * sizeof(Task));
+    if (!q->tasks) return -1;
+    pthread_mutex_init(&q->lock, NULL);
+    return 0;
+}
+
+static void deque_free(TaskDeque *q) {
+    pthread_mutex_destroy(&q->lock);
+    free(q->tasks);
+}
+
+static int deque_push(TaskDeque *q, Task task) {
+    pthread_mutex_lock(&q->lock);
+
+    if (q->count == q->capacity) {
+        // Unroll the circular buffer into one twice the size
+        Task *grown = (Task *)malloc(2 * q->capacity * sizeof(Task));
+        if (!grown) {
+            pthread_mutex_unlock(&q->lock);
+            return -1;
+        }
+        for (int i = 0; i < q->count; i++) {
+            grown[i] = q->tasks[(q->top + i) % q->capacity];
+        }
+        free(q->tasks);
+        q->tasks = grown;
+        q->capacity *= 2;
+        q->top = 0;
+    }
+
+    q->tasks[(q->top + q->count) % q->capacity] = task;
+    q->count++;
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+// Owner side: newest task first, while it is still warm in this core's cache
+static int deque_pop_bottom(TaskDeque *q, Task *task) {
+    int found = 0;
+    pthread_mutex_lock(&q->lock);
+    if (q->count > 0) {
+        q->count--;
+        *task = q->tasks[(q->top + q->count) % q->capacity];
+        found = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return found;
+}
+
+// Thief side: oldest task, the one the owner is least likely to reach soon
+static int deque_steal_top(TaskDeque *q, Task *task) {
+    int found = 0;
+    pthread_mutex_lock(&q->lock);
+    if (q->count > 0) {
+        *task = q->tasks[q->top];
+        q->top = (q->top + 1) % q->capacity;
+        q->count--;
+        found = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return found;
+}
+
+static int take_task(Worker *w, Task *task) {
+    ThreadPool *pool = w->pool;
+
+    if (deque_pop_bottom(&w->deque, task)) return 1;
+
+    for (int i = 1; i < pool->threadCount; i++) {
+        Worker *victim = &pool->workers[(w->index + i) % pool->threadCount];
+        if (deque_steal_top(&victim->deque, task)) {
+            atomic_fetch_add(&pool->steals, 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = (Worker *)arg;
+    ThreadPool *pool = w->pool;
+
+    currentWorker = w;
+    if (pool->flags & THREAD_POOL_PIN) pin_to_cpu(w->index % cpu_count());
+
+    for (;;) {
+        Task task;
+        if (take_task(w, &task)) {
+            atomic_fetch_sub(&pool->queued, 1);
+            task.fn(task.arg);
+            if (atomic_fetch_sub(&pool->unfinished, 1) == 1) {
+                pthread_mutex_lock(&pool->lock);
+                pthread_cond_broadcast(&pool->allDone);
+                pthread_mutex_unlock(&pool->lock);
+            }
+            continue;
+        }
+
+        // Nothing to run or steal: sleep until a submission or shutdown
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->queued) == 0 && !pool->shutdown) {
+            pthread_cond_wait(&pool->workReady, &pool->lock);
+        }
+        int stop = atomic_load(&pool->queued) == 0 && pool->shutdown;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) break;
+    }
+
+    currentWorker = NULL;
+    return NULL;
+}
+
+ThreadPool *thread_pool_create(int threads, int flags) {
+    if (threads <= 0) threads = cpu_count();
+
+    ThreadPool *pool = (ThreadPool *)calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    pool->flags = flags;
+    pool->workers = (Worker *)calloc(threads, sizeof(Worker));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->unfinished, 0);
+    atomic_init(&pool->nextDeque, 0);
+    atomic_init(&pool->steals, 0);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->workReady, NULL);
+    pthread_cond_init(&pool->allDone, NULL);
+
+    // Deques must all exist before the first worker starts stealing
+    int ready = 0;
+    while (ready < threads && deque_init(&pool->workers[ready].deque) == 0) {
+        pool->workers[ready].pool = pool;
+        pool->workers[ready].index = ready;
+        ready++;
+    }
+    pool->threadCount = ready;
+
+    while (pool->started < ready &&
+           pthread_create(&pool->workers[pool->started].thread, NULL, worker_main,
+                          &pool->workers[pool->started]) == 0) {
+        pool->started++;
+    }
+
+    if (ready == 0 || pool->started < ready) {
+        thread_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void thread_pool_destroy(ThreadPool *pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->workReady);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->started; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < pool->threadCount; i++) {
+        deque_free(&pool->workers[i].deque);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->workReady);
+    pthread_cond_destroy(&pool->allDone);
+    free(pool->workers);
+    free(pool);
+}
+
+int thread_pool_submit(ThreadPool *pool, TaskFn fn, void *arg) {
+    Worker *target = currentWorker;
+    if (!target || target->pool != pool) {
+        unsigned next = atomic_fetch_add(&pool->nextDeque, 1);
+        target = &pool->workers[next % pool->threadCount];
+    }
+
+    atomic_fetch_add(&pool->unfinished, 1);
+    if (deque_push(&target->deque, (Task){fn, arg}) != 0) {
+        atomic_fetch_sub(&pool->unfinished, 1);
+        return -1;
+    }
+    atomic_fetch_add(&pool->queued, 1);
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->workReady);
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+void thread_pool_wait(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->unfinished) > 0) {
+        pthread_cond_wait(&pool->allDone, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int thread_pool_size(const ThreadPool *pool) {
+    return pool->threadCount;
+}
+
+long thread_pool_steals(const ThreadPool *pool) {
+    return atomic_load(&((ThreadPool *)pool)->steals);
+}
@@ -0,0 +1,39 @@
+// Work-stealing worker pool.
+//
+// Tasks are plain function pointers with one argument. Every worker owns a
+// deque: it takes its own work newest first and, once that runs dry, steals
+// the oldest task from another worker. Tasks submitted from outside the pool
+// are dealt round-robin over the deques, tasks submitted by a worker go to
+// its own deque. thread_pool_wait() blocks until every submitted task has
+// finished.
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define THREAD_POOL_PIN 1   // Pin worker i to CPU i % cpu_count()
+
+typedef void (*TaskFn)(void *arg);
+
+typedef struct ThreadPool ThreadPool;
+
+// threads <= 0 uses one worker per online CPU. Returns NULL on failure.
+ThreadPool *thread_pool_create(int threads, int flags);
+void thread_pool_destroy(ThreadPool *pool);
+
+int thread_pool_submit(ThreadPool *pool, TaskFn fn, void *arg);
+void thread_pool_wait(ThreadPool *pool);
+int thread_pool_size(const ThreadPool *pool);
+
+// Number of tasks a worker took from another worker's deque
+long thread_pool_steals(const ThreadPool *pool);
+
+int cpu_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // THREAD_POOL_H
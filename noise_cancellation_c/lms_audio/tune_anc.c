@@ -0,0 +1,536 @@
+// Parameter search for the noise cancellation engines.
+//
+// The noisy/noise recording pair is decoded to mono float once, and a
+// thread pool runs whole configurations (engine, taps, mu, lambda, delta)
+// over those shared read-only buffers, one task per configuration. Quality
+// is the ERLE of the output, or its SNR against --clean, measured by
+// anc_metrics once the filter has had --settle seconds to converge, and the
+// convergence time is reported next to it. Speed is the CPU time of the
+// worker thread per sample, so configurations running side by side do not
+// inflate each other's figures. The tool prints every configuration it
+// tried and the fastest one that reaches --target dB.
+//
+// --search grid tries every combination of the lists. --search coordinate
+// starts each engine from its defaults and sweeps one parameter at a time
+// over its list, keeping the best value, until a whole round changes
+// nothing; with several lists that is far fewer runs than the grid.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "wav_io.h"
+#include "pcm_convert.h"
+#include "anc_engine.h"
+#include "anc_metrics.h"
+#include "fft.h"
+#include "thread_pool.h"
+
+#define FRAME_SIZE 1024       // Samples per engine call
+#define MAX_LIST 32           // Entries per --taps/--mu/--lambda/--delta list
+#define MAX_ROUNDS 8          // Coordinate search gives up after this many rounds
+#define DEFAULT_TARGET 10.0   // dB
+#define AXES 4                // taps, mu, lambda, delta
+
+static const char *axisNames[AXES] = {"taps", "mu", "lambda", "delta"};
+
+// The decoded recordings, shared by every trial
+typedef struct {
+    float *noisy, *noise, *clean;   // clean is NULL without --clean
+    size_t length;
+    size_t settle;                  // Samples left out of the quality measure
+    int sampleRate;
+} Recording;
+
+// The values each parameter takes for one engine; parameters the engine
+// does not have get the single value 0 (its default)
+typedef struct {
+    const ANCEngineType *type;
+    double values[AXES][MAX_LIST];
+    int counts[AXES];
+} EngineAxes;
+
+typedef struct {
+    const EngineAxes *axes;
+    int index[AXES];                // Into axes->values
+    const Recording *rec;
+
+    int status;                     // 1 until run, then 0, or -1 if the engine could not be set up
+    double quality;                 // ERLE or SNR in dB
+    double convergence;             // Seconds, -1 if unknown
+    double nsPerSample;
+} Trial;
+
+typedef struct {
+    Trial *items;
+    int count, capacity;
+} TrialList;
+
+static double thread_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double trial_value(const Trial *t, int axis) {
+    return t->axes->values[axis][t->index[axis]];
+}
+
+// ---- Running one configuration ----
+
+static void run_trial(void *arg) {
+    Trial *t = (Trial *)arg;
+    const Recording *rec = t->rec;
+    ANCEngine *engine = anc_engine_create_tuned(t->axes->type->name, (int)trial_value(t, 0), (float)trial_value(t, 1),
+                                                trial_value(t, 2), trial_value(t, 3), FRAME_SIZE);
+    float *out = (float *)malloc(FRAME_SIZE * sizeof(float));
+    ANCMetrics metrics;
+    if (!engine || !out ||
+        anc_metrics_init(&metrics, rec->sampleRate, 1, (double)rec->settle / rec->sampleRate, rec->clean != NULL) != 0) {
+        t->status = -1;
+        anc_engine_destroy(engine);
+        free(out);
+        return;
+    }
+
+    // Output j belongs to input j - latency
+    double seconds = 0.0;
+    size_t latency = (size_t)engine->latency;
+    int status = 0;
+    for (size_t pos = 0; pos < rec->length && status == 0; pos += FRAME_SIZE) {
+        int count = rec->length - pos < FRAME_SIZE ? (int)(rec->length - pos) : FRAME_SIZE;
+        double start = thread_seconds();
+        anc_engine_process(engine, rec->noise + pos, rec->noisy + pos, out, count);
+        seconds += thread_seconds() - start;
+
+        int skip = pos >= latency ? 0 : latency - pos < (size_t)count ? (int)(latency - pos) : count;
+        size_t at = pos + skip - latency;
+        if (skip < count) {
+            status = anc_metrics_push(&metrics, rec->noisy + at, out + skip, rec->clean ? rec->clean + at : NULL,
+                                      count - skip);
+        }
+    }
+
+    ANCMetricsResult result;
+    anc_metrics_result(&metrics, &result);
+    t->status = status;
+    t->quality = rec->clean ? result.snr : result.erle;
+    t->convergence = result.convergence;
+    t->nsPerSample = seconds * 1e9 / rec->length;
+    anc_metrics_free(&metrics);
+    anc_engine_destroy(engine);
+    free(out);
+}
+
+// Passing beats failing; among passing trials the faster wins, among
+// failing ones the better
+static int better(const Trial *a, const Trial *b, double target) {
+    if (a->status != 0) return 0;
+    if (b->status != 0) return 1;
+    int passA = a->quality >= target, passB = b->quality >= target;
+    if (passA != passB) return passA;
+    return passA ? a->nsPerSample < b->nsPerSample : a->quality > b->quality;
+}
+
+// Index of the trial with these settings, adding it (not yet run) if it is new
+static int trial_find_or_add(TrialList *list, const EngineAxes *axes, const int *index, const Recording *rec) {
+    for (int i = 0; i < list->count; i++) {
+        if (list->items[i].axes == axes && memcmp(list->items[i].index, index, sizeof(int) * AXES) == 0) return i;
+    }
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? 2 * list->capacity : 64;
+        Trial *items = (Trial *)realloc(list->items, capacity * sizeof(Trial));
+        if (!items) return -1;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    Trial *t = &list->items[list->count];
+    memset(t, 0, sizeof(*t));
+    t->axes = axes;
+    memcpy(t->index, index, sizeof(int) * AXES);
+    t->rec = rec;
+    t->status = 1;   // Pending
+    return list->count++;
+}
+
+// Run every pending trial, in parallel
+static void run_pending(ThreadPool *pool, TrialList *list) {
+    for (int i = 0; i < list->count; i++) {
+        if (list->items[i].status == 1 && thread_pool_submit(pool, run_trial, &list->items[i]) != 0) {
+            run_trial(&list->items[i]);
+        }
+    }
+    thread_pool_wait(pool);
+}
+
+// ---- Searches ----
+
+static int grid_search(ThreadPool *pool, TrialList *list, const EngineAxes *engines, int engineCount,
+                       const Recording *rec) {
+    for (int e = 0; e < engineCount; e++) {
+        const EngineAxes *axes = &engines[e];
+        int index[AXES] = {0, 0, 0, 0};
+        for (;;) {
+            if (trial_find_or_add(list, axes, index, rec) < 0) return -1;
+
+            // Odometer over the four lists
+            int a = 0;
+            while (a < AXES && ++index[a] == axes->counts[a]) index[a++] = 0;
+            if (a == AXES) break;
+        }
+    }
+    run_pending(pool, list);
+    return 0;
+}
+
+// Index of the list entry closest to v, on a log scale
+static int closest(const double *values, int count, double v) {
+    int best = 0;
+    for (int i = 1; i < count; i++) {
+        if (fabs(log(values[i] / v)) < fabs(log(values[best] / v))) best = i;
+    }
+    return best;
+}
+
+// All engines advance together, one parameter per step, so every step has
+// a whole sweep per engine to spread over the workers
+static int coordinate_search(ThreadPool *pool, TrialList *list, const EngineAxes *engines, int engineCount,
+                             const Recording *rec, double target) {
+    typedef struct {
+        int index[AXES];
+        int axis;       // Parameter swept in this step
+        int changed;    // Anything moved in this round
+        int rounds;
+        int done;
+    } Cursor;
+
+    Cursor *cursors = (Cursor *)calloc(engineCount, sizeof(Cursor));
+    if (!cursors) return -1;
+    for (int e = 0; e < engineCount; e++) {
+        const EngineAxes *axes = &engines[e];
+        const ANCEngineType *type = axes->type;
+        double defaults[AXES] = {type->defaultTaps, type->defaultMu, ANC_DEFAULT_LAMBDA, ANC_DEFAULT_DELTA};
+        for (int a = 0; a < AXES; a++) {
+            cursors[e].index[a] = axes->values[a][0] > 0.0 ? closest(axes->values[a], axes->counts[a], defaults[a]) : 0;
+        }
+    }
+
+    for (;;) {
+        int active = 0;
+        for (int e = 0; e < engineCount; e++) {
+            Cursor *c = &cursors[e];
+            if (c->done) continue;
+            active = 1;
+            int index[AXES];
+            memcpy(index, c->index, sizeof(index));
+            for (int v = 0; v < engines[e].counts[c->axis]; v++) {
+                index[c->axis] = v;
+                if (trial_find_or_add(list, &engines[e], index, rec) < 0) {
+                    free(cursors);
+                    return -1;
+                }
+            }
+        }
+        if (!active) break;
+        run_pending(pool, list);
+
+        for (int e = 0; e < engineCount; e++) {
+            Cursor *c = &cursors[e];
+            if (c->done) continue;
+            int index[AXES], best = c->index[c->axis];
+            memcpy(index, c->index, sizeof(index));
+            const Trial *bestTrial = &list->items[trial_find_or_add(list, &engines[e], index, rec)];
+            for (int v = 0; v < engines[e].counts[c->axis]; v++) {
+                index[c->axis] = v;
+                const Trial *t = &list->items[trial_find_or_add(list, &engines[e], index, rec)];
+                if (better(t, bestTrial, target)) {
+                    bestTrial = t;
+                    best = v;
+                }
+            }
+            if (best != c->index[c->axis]) {
+                c->index[c->axis] = best;
+                c->changed = 1;
+            }
+
+            // Next parameter with more than one value; a round without a
+            // change means every sweep agrees with the current point
+            do {
+                if (++c->axis == AXES) {
+                    c->axis = 0;
+                    c->done = !c->changed || ++c->rounds == MAX_ROUNDS;
+                    c->changed = 0;
+                }
+            } while (!c->done && engines[e].counts[c->axis] < 2);
+        }
+    }
+
+    free(cursors);
+    return 0;
+}
+
+// ---- Setup ----
+
+// Comma-separated positive numbers; returns the number parsed, or -1 on a
+// bad entry or more than max of them
+static int parse_values(const char *text, double *values, int max) {
+    int count = 0;
+    while (*text && count < max) {
+        char *end;
+        double v = strtod(text, &end);
+        if (end == text || v <= 0.0) return -1;
+        values[count++] = v;
+        text = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+    if (*text) {
+        printf("Error: A list takes at most %d values\n", max);
+        return -1;
+    }
+    return count;
+}
+
+static int listed(const char *list, const char *name) {
+    size_t length = strlen(name);
+    for (const char *p = list; p && *p;) {
+        const char *comma = strchr(p, ',');
+        size_t itemLength = comma ? (size_t)(comma - p) : strlen(p);
+        if (itemLength == length && strncmp(p, name, length) == 0) return 1;
+        p = comma ? comma + 1 : NULL;
+    }
+    return 0;
+}
+
+// The lists for one engine: the given ones, or a spread around its defaults.
+// Tap counts the engine cannot run are dropped, and its shared tables are
+// built here, before the workers start. Returns the number of tap counts left.
+static int engine_axes(const ANCEngineType *type, double *const lists[AXES], const int *counts, EngineAxes *axes) {
+    static const double muScale[] = {0.25, 0.5, 1.0, 2.0};
+    static const double lambdas[] = {0.99, 0.995, 0.999};
+
+    memset(axes, 0, sizeof(*axes));
+    axes->type = type;
+    if (counts[0] > 0) {
+        for (int i = 0; i < counts[0]; i++) axes->values[0][axes->counts[0]++] = lists[0][i];
+    } else {
+        for (int scale = 1; scale <= 4; scale *= 2) axes->values[0][axes->counts[0]++] = type->defaultTaps * scale / 2;
+    }
+    int kept = 0;
+    for (int i = 0; i < axes->counts[0]; i++) {
+        double taps = axes->values[0][i];
+        if (taps >= 1.0 && taps == floor(taps) && anc_engine_prepare(type, (int)taps) == 0) {
+            axes->values[0][kept++] = taps;
+        }
+    }
+    axes->counts[0] = kept;
+
+    if (type->defaultMu <= 0.0f) {
+        axes->counts[1] = 1;
+    } else if (counts[1] > 0) {
+        memcpy(axes->values[1], lists[1], counts[1] * sizeof(double));
+        axes->counts[1] = counts[1];
+    } else {
+        for (int i = 0; i < 4; i++) axes->values[1][i] = type->defaultMu * muScale[i];
+        axes->counts[1] = 4;
+    }
+
+    if (!(type->flags & ANC_FORGETTING)) {
+        axes->counts[2] = axes->counts[3] = 1;
+    } else {
+        if (counts[2] > 0) {
+            memcpy(axes->values[2], lists[2], counts[2] * sizeof(double));
+            axes->counts[2] = counts[2];
+        } else {
+            memcpy(axes->values[2], lambdas, sizeof(lambdas));
+            axes->counts[2] = 3;
+        }
+        if (counts[3] > 0) {
+            memcpy(axes->values[3], lists[3], counts[3] * sizeof(double));
+            axes->counts[3] = counts[3];
+        } else {
+            axes->values[3][0] = ANC_DEFAULT_DELTA;
+            axes->counts[3] = 1;
+        }
+    }
+    return kept;
+}
+
+// Decode a WAV file to mono float. Returns NULL (after printing why) on failure.
+static float *load_mono(const char *path, size_t *frames, int *sampleRate) {
+    WAVFile wav;
+    if (wav_open(path, &wav) != 0) return NULL;
+
+    PCMEncoding encoding = pcm_encoding(&wav.fmt);
+    float *samples = NULL;
+    if (encoding == PCM_UNSUPPORTED) {
+        printf("Error: %s is neither PCM nor IEEE float\n", path);
+    } else if (!(samples = (float *)malloc((wav.numFrames ? wav.numFrames : 1) * sizeof(float)))) {
+        printf("Error: Out of memory\n");
+    } else {
+        pcm_to_mono(wav.data, encoding, wav.fmt.numChannels, wav.numFrames, samples);
+        *frames = wav.numFrames;
+        *sampleRate = wav.fmt.sampleRate;
+    }
+    wav_close(&wav);
+    return samples;
+}
+
+static void print_trial(const Trial *t, int sampleRate, double target) {
+    printf("%-20s %6d", t->axes->type->name, (int)trial_value(t, 0));
+    for (int a = 1; a < AXES; a++) {
+        if (t->axes->values[a][0] > 0.0) {
+            printf(" %9.4g", trial_value(t, a));
+        } else {
+            printf(" %9s", "-");
+        }
+    }
+    if (t->status != 0) {
+        printf("  setup failed\n");
+        return;
+    }
+    printf(" %8.2f", t->quality);
+    if (t->convergence >= 0.0) {
+        printf(" %9.2f", t->convergence);
+    } else {
+        printf(" %9s", "-");
+    }
+    printf(" %10.1f %9.0fx%s\n", t->nsPerSample, 1e9 / (t->nsPerSample * sampleRate),
+           t->quality >= target ? "" : "  below target");
+}
+
+int main(int argc, char *argv[]) {
+    const char *engineList = NULL;  // NULL: every engine that uses the reference
+    const char *cleanPath = NULL;
+    const char *search = "grid";
+    double target = DEFAULT_TARGET, settleSeconds = -1.0;
+    int threads = 0;
+    double lists[AXES][MAX_LIST];
+    int counts[AXES] = {0, 0, 0, 0};
+
+    int arg = 1, valid = 1;
+    while (arg + 1 < argc && strncmp(argv[arg], "--", 2) == 0) {
+        const char *value = argv[arg + 1];
+        int axis = -1;
+        for (int a = 0; a < AXES; a++) {
+            if (strcmp(argv[arg] + 2, axisNames[a]) == 0) axis = a;
+        }
+        if (axis >= 0) {
+            counts[axis] = parse_values(value, lists[axis], MAX_LIST);
+            if (counts[axis] <= 0) valid = 0;
+        } else if (strcmp(argv[arg], "--engines") == 0) {
+            engineList = value;
+        } else if (strcmp(argv[arg], "--search") == 0) {
+            search = value;
+        } else if (strcmp(argv[arg], "--target") == 0) {
+            target = atof(value);
+        } else if (strcmp(argv[arg], "--clean") == 0) {
+            cleanPath = value;
+        } else if (strcmp(argv[arg], "--settle") == 0) {
+            settleSeconds = atof(value);
+        } else if (strcmp(argv[arg], "--threads") == 0) {
+            threads = atoi(value);
+        } else {
+            valid = 0;
+        }
+        arg += 2;
+    }
+    for (int i = 0; i < counts[2]; i++) {
+        if (lists[2][i] > 1.0) valid = 0;
+    }
+    int coordinate = strcmp(search, "coordinate") == 0;
+    if (!valid || argc - arg != 2 || (!coordinate && strcmp(search, "grid") != 0)) {
+        printf("Usage: %s [--engines %s] [--taps N,...] [--mu MU,...] [--lambda L,...] [--delta D,...]"
+               " [--search grid|coordinate] [--target DB] [--clean clean.wav] [--settle SECONDS] [--threads N]"
+               " <noisy.wav> <noise.wav>\n",
+               argv[0], anc_engine_names(","));
+        return 1;
+    }
+
+    // Decode both recordings once; every trial reads the same buffers
+    Recording rec = {NULL, NULL, NULL, 0, 0, 0};
+    size_t noisyFrames = 0, noiseFrames = 0, cleanFrames = 0;
+    int noiseRate = 0, cleanRate = 0;
+    rec.noisy = load_mono(argv[arg], &noisyFrames, &rec.sampleRate);
+    rec.noise = rec.noisy ? load_mono(argv[arg + 1], &noiseFrames, &noiseRate) : NULL;
+    if (cleanPath && rec.noise) rec.clean = load_mono(cleanPath, &cleanFrames, &cleanRate);
+    int status = rec.noisy && rec.noise && (!cleanPath || rec.clean) ? 0 : -1;
+    if (status == 0 && (noiseRate != rec.sampleRate || (cleanPath && cleanRate != rec.sampleRate))) {
+        printf("Error: The recordings have different sample rates\n");
+        status = -1;
+    }
+    rec.length = noisyFrames < noiseFrames ? noisyFrames : noiseFrames;
+    if (cleanPath && cleanFrames < rec.length) rec.length = cleanFrames;
+    rec.settle = settleSeconds >= 0.0 ? (size_t)(settleSeconds * rec.sampleRate) : rec.length / 2;
+    if (status == 0 && rec.settle >= rec.length) {
+        printf("Error: Nothing left to measure after %.2f s of settling\n", (double)rec.settle / rec.sampleRate);
+        status = -1;
+    }
+
+    // The lists per engine
+    EngineAxes *engines = (EngineAxes *)calloc(anc_engine_count(), sizeof(EngineAxes));
+    int engineCount = 0;
+    double *listPointers[AXES] = {lists[0], lists[1], lists[2], lists[3]};
+    if (!engines) status = -1;
+    for (int i = 0; status == 0 && i < anc_engine_count(); i++) {
+        const ANCEngineType *type = anc_engine_type(i);
+        if (engineList ? !listed(engineList, type->name) : (type->flags & ANC_NO_REFERENCE) != 0) continue;
+        if (engine_axes(type, listPointers, counts, &engines[engineCount]) > 0) {
+            engineCount++;
+        } else {
+            printf("Skipping %s: none of the tap counts suits it\n", type->name);
+        }
+    }
+    if (status == 0 && engineCount == 0) {
+        printf("Error: No engine to tune\n");
+        status = -1;
+    }
+
+    TrialList list = {NULL, 0, 0};
+    ThreadPool *pool = status == 0 ? thread_pool_create(threads, 0) : NULL;
+    if (status == 0 && !pool) {
+        printf("Error: Cannot start the worker threads\n");
+        status = -1;
+    }
+    const char *metric = rec.clean ? "SNR" : "ERLE";
+    if (status == 0) {
+        printf("Tuning %d engine(s) on %.1f s of audio (%.1f s settling), %s search, %d thread(s), target %.1f dB %s\n",
+               engineCount, (double)rec.length / rec.sampleRate, (double)rec.settle / rec.sampleRate, search,
+               thread_pool_size(pool), target, metric);
+        status = coordinate ? coordinate_search(pool, &list, engines, engineCount, &rec, target)
+                            : grid_search(pool, &list, engines, engineCount, &rec);
+        if (status != 0) printf("Error: Out of memory\n");
+    }
+
+    if (status == 0) {
+        printf("%-20s %6s %9s %9s %9s %8s %9s %10s %10s\n", "engine", "taps", "mu", "lambda", "delta", metric,
+               "converged", "ns/sample", "real time");
+        const Trial *best = &list.items[0];
+        for (int i = 0; i < list.count; i++) {
+            print_trial(&list.items[i], rec.sampleRate, target);
+            if (better(&list.items[i], best, target)) best = &list.items[i];
+        }
+
+        if (best->status != 0) {
+            printf("No configuration could be set up\n");
+            status = -1;
+        } else {
+            printf("\n%s: --mode %s --taps %d", best->quality >= target ? "Fastest configuration reaching the target"
+                                                                : "Nothing reaches the target; closest",
+                   best->axes->type->name, (int)trial_value(best, 0));
+            for (int a = 1; a < AXES; a++) {
+                if (best->axes->values[a][0] > 0.0) printf(" --%s %g", axisNames[a], trial_value(best, a));
+            }
+            printf(" (%.2f dB %s, %.1f ns/sample)\n", best->quality, metric, best->nsPerSample);
+            if (best->quality < target) status = -1;
+        }
+    }
+
+    thread_pool_destroy(pool);
+    free(list.items);
+    free(engines);
+    free(rec.noisy);
+    free(rec.noise);
+    free(rec.clean);
+    fft_plan_cache_free();
+    return status == 0 ? 0 : 1;
+}
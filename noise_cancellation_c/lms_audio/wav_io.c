@@ -0,0 +1,218 @@
+#include "wav_io.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// RIFF fields are little-endian regardless of the host
+static uint32_t read_u32le(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16le(const unsigned char *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void put_u32le(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static void put_u16le(unsigned char *p, uint16_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static int map_file(const char *filename, WAVFile *wav) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return -1;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return -1;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return -1;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return -1;
+    }
+
+    wav->fileHandle = file;
+    wav->mapHandle = mapping;
+    wav->map = view;
+    wav->mapSize = (size_t)size.QuadPart;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return -1;
+    }
+
+    void *view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps its own reference to the file
+    if (view == MAP_FAILED) return -1;
+
+#ifdef MADV_SEQUENTIAL
+    madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+
+    wav->map = view;
+    wav->mapSize = (size_t)st.st_size;
+#endif
+    return 0;
+}
+
+int wav_open(const char *filename, WAVFile *wav) {
+    memset(wav, 0, sizeof(*wav));
+
+    if (map_file(filename, wav) != 0) {
+        printf("Error opening WAV file %s\n", filename);
+        return -1;
+    }
+
+    const unsigned char *base = (const unsigned char *)wav->map;
+    size_t size = wav->mapSize;
+
+    if (size < 12 || memcmp(base, "RIFF", 4) != 0 || memcmp(base + 8, "WAVE", 4) != 0) {
+        printf("Error: %s is not a RIFF/WAVE file\n", filename);
+        wav_close(wav);
+        return -1;
+    }
+
+    // Walk the chunk list. Chunks are word-aligned, so odd sizes carry a pad byte.
+    int haveFmt = 0, haveData = 0;
+    size_t pos = 12;
+    while (pos + 8 <= size && !(haveFmt && haveData)) {
+        const unsigned char *chunk = base + pos;
+        size_t chunkSize = read_u32le(chunk + 4);
+        size_t body = pos + 8;
+        size_t avail = size - body;
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunkSize < 16 || chunkSize > avail) break;
+            wav->fmt.audioFormat = (short)read_u16le(chunk + 8);
+            wav->fmt.numChannels = (short)read_u16le(chunk + 10);
+            wav->fmt.sampleRate = (int)read_u32le(chunk + 12);
+            wav->fmt.byteRate = (int)read_u32le(chunk + 16);
+            wav->fmt.blockAlign = (short)read_u16le(chunk + 20);
+            wav->fmt.bitsPerSample = (short)read_u16le(chunk + 22);
+            // WAVE_FORMAT_EXTENSIBLE carries the real format code in the
+            // first two bytes of its SubFormat GUID
+            if ((unsigned short)wav->fmt.audioFormat == WAV_FORMAT_EXTENSIBLE && chunkSize >= 40) {
+                wav->fmt.audioFormat = (short)read_u16le(chunk + 32);
+            }
+            haveFmt = 1;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            // Streaming writers leave an oversized placeholder (0xFFFFFFFF) and
+            // interrupted recorders a length past the end; trust the file. A
+            // length of 0 is an empty recording, whatever chunks follow it.
+            if (chunkSize > avail) chunkSize = avail;
+            wav->data = chunk + 8;
+            wav->dataSize = chunkSize;
+            haveData = 1;
+        }
+
+        pos = body + chunkSize + (chunkSize & 1);
+    }
+
+    if (!haveFmt || !haveData || wav->fmt.blockAlign <= 0 || wav->fmt.numChannels <= 0) {
+        printf("Error: %s has no usable fmt/data chunks\n", filename);
+        wav_close(wav);
+        return -1;
+    }
+
+    wav->numFrames = wav->dataSize / (size_t)wav->fmt.blockAlign;
+    wav->dataSize = wav->numFrames * (size_t)wav->fmt.blockAlign; // Drop a trailing partial frame
+    wav->numSamples = wav->numFrames * (size_t)wav->fmt.numChannels;
+    return 0;
+}
+
+void wav_close(WAVFile *wav) {
+    if (!wav->map) return;
+#ifdef _WIN32
+    UnmapViewOfFile(wav->map);
+    CloseHandle((HANDLE)wav->mapHandle);
+    CloseHandle((HANDLE)wav->fileHandle);
+#else
+    munmap(wav->map, wav->mapSize);
+#endif
+    memset(wav, 0, sizeof(*wav));
+}
+
+const short *wav_samples_i16(const WAVFile *wav) {
+    if (wav->fmt.audioFormat != WAV_FORMAT_PCM || wav->fmt.bitsPerSample != 16) return NULL;
+    return (const short *)wav->data;
+}
+
+int wav_write_header(FILE *file, const WAVFormat *fmt, size_t dataSize) {
+    unsigned char header[44];
+
+    memcpy(header, "RIFF", 4);
+    put_u32le(header + 4, (uint32_t)(36 + dataSize));
+    memcpy(header + 8, "WAVE", 4);
+    memcpy(header + 12, "fmt ", 4);
+    put_u32le(header + 16, 16);
+    put_u16le(header + 20, (uint16_t)fmt->audioFormat);
+    put_u16le(header + 22, (uint16_t)fmt->numChannels);
+    put_u32le(header + 24, (uint32_t)fmt->sampleRate);
+    put_u32le(header + 28, (uint32_t)fmt->byteRate);
+    put_u16le(header + 32, (uint16_t)fmt->blockAlign);
+    put_u16le(header + 34, (uint16_t)fmt->bitsPerSample);
+    memcpy(header + 36, "data", 4);
+    put_u32le(header + 40, (uint32_t)dataSize);
+
+    return fwrite(header, sizeof(header), 1, file) == 1 ? 0 : -1;
+}
+
+int wav_update_sizes(FILE *file, size_t dataSize) {
+    unsigned char field[4];
+    long end = ftell(file);
+
+    put_u32le(field, (uint32_t)(36 + dataSize));
+    if (fseek(file, 4, SEEK_SET) != 0 || fwrite(field, 4, 1, file) != 1) return -1;
+
+    put_u32le(field, (uint32_t)dataSize);
+    if (fseek(file, 40, SEEK_SET) != 0 || fwrite(field, 4, 1, file) != 1) return -1;
+
+    return fseek(file, end, SEEK_SET);
+}
+
+int wav_write_i16(const char *filename, const WAVFormat *fmt, const short *data, size_t numSamples) {
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        printf("Error opening output file %s\n", filename);
+        return -1;
+    }
+
+    size_t dataSize = numSamples * sizeof(short);
+    int status = wav_write_header(file, fmt, dataSize);
+    if (status == 0 && fwrite(data, sizeof(short), numSamples, file) != numSamples) status = -1;
+    if (fclose(file) != 0) status = -1;
+
+    if (status != 0) printf("Error writing output file %s\n", filename);
+    return status;
+}
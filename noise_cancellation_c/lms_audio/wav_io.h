@@ -0,0 +1,75 @@
+// Shared RIFF/WAVE reader and writer.
+//
+// wav_open() maps the whole file read-only and walks the RIFF chunk list to
+// find "fmt " and "data", so files carrying LIST/INFO, fact or other chunks
+// are handled correctly. The samples are handed back as a pointer straight
+// into the mapping: nothing is copied and nothing is read through stdio.
+#ifndef WAV_IO_H
+#define WAV_IO_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WAV_FORMAT_PCM        1
+#define WAV_FORMAT_IEEE_FLOAT 3
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE   // Resolved to its SubFormat by wav_open()
+
+// Contents of the "fmt " chunk
+typedef struct {
+    short audioFormat;
+    short numChannels;
+    int sampleRate;
+    int byteRate;
+    short blockAlign;
+    short bitsPerSample;
+} WAVFormat;
+
+// A mapped WAV file. Only fmt, data, dataSize, numFrames and numSamples
+// are meant to be read by callers.
+typedef struct {
+    WAVFormat fmt;
+    const void *data;    // First byte of the "data" payload
+    size_t dataSize;     // Payload size in bytes, clamped to the file
+    size_t numFrames;    // dataSize / blockAlign
+    size_t numSamples;   // numFrames * numChannels (interleaved)
+
+    void *map;
+    size_t mapSize;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mapHandle;
+#endif
+} WAVFile;
+
+// Map a WAV file. Returns 0 on success, -1 (after printing why) on failure.
+int wav_open(const char *filename, WAVFile *wav);
+void wav_close(WAVFile *wav);
+
+// Interleaved 16-bit PCM view of the data chunk, or NULL for other formats.
+//
+// Samples are read in place and written out as they are in memory. RIFF
+// data is little-endian, so every tool assumes a little-endian host, and
+// including this header is enough to refuse to build anywhere else.
+const short *wav_samples_i16(const WAVFile *wav);
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "RIFF samples are used in host byte order, which must be little-endian"
+#endif
+
+// Write a canonical 44-byte header. dataSize may be 0 and patched later
+// with wav_update_sizes() once the payload length is known.
+int wav_write_header(FILE *file, const WAVFormat *fmt, size_t dataSize);
+int wav_update_sizes(FILE *file, size_t dataSize);
+
+// Write a complete 16-bit PCM file in one go
+int wav_write_i16(const char *filename, const WAVFormat *fmt, const short *data, size_t numSamples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAV_IO_H